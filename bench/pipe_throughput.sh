@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# Пропускная способность конвейеров CustomShell: GB/s через N стадий cat
+# с системной ёмкостью пайпов и с увеличенной (--pipe-size), а также встроенный tee (tee(2)/splice(2))
+# против внешнего /usr/bin/tee.
+# Usage: ./pipe_throughput.sh <CustomShell binary> [size_mb] [pipe_size]
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <CustomShell binary> [size_mb] [pipe_size]"
+    echo "Example: $0 ../build/CustomShell 2048 1M"
+    exit 1
+fi
+
+SHELL_BIN=$1
+SIZE_MB=${2:-2048}
+PIPE_SIZE=${3:-1M}
+TEE_BIN=$(command -v tee)
+
+if [ ! -x "$SHELL_BIN" ]; then
+    echo "Error: $SHELL_BIN not found or not executable"
+    exit 1
+fi
+
+# Строка конвейера: head | cat x (stages-2) | wc -c
+pipeline() {
+    local stages=$1
+    local middle=$2
+    local line="head -c ${SIZE_MB}M /dev/zero"
+    for ((i=2; i<stages; i++)); do
+        line="$line | $middle"
+    done
+    echo "$line | wc -c"
+}
+
+run() {
+    local name=$1
+    local stages=$2
+    local line=$3
+    shift 3
+    local start end elapsed_ms
+    start=$(date +%s%N)
+    echo "$line" | "$SHELL_BIN" "$@" > /dev/null
+    end=$(date +%s%N)
+    elapsed_ms=$(( (end - start) / 1000000 ))
+    [ "$elapsed_ms" -eq 0 ] && elapsed_ms=1
+    printf "%-14s %3d stages %8d ms %8s GB/s\n" "$name" "$stages" "$elapsed_ms" \
+        "$(awk -v mb="$SIZE_MB" -v ms="$elapsed_ms" 'BEGIN { printf "%.2f", mb / 1024 / (ms / 1000) }')"
+}
+
+echo "Data: ${SIZE_MB} MiB, enlarged pipe size: $PIPE_SIZE"
+for stages in 2 4 8 16; do
+    run "default" "$stages" "$(pipeline "$stages" cat)"
+    run "pipe-size" "$stages" "$(pipeline "$stages" cat)" --pipe-size "$PIPE_SIZE"
+done
+
+echo
+for stages in 3 4 8; do
+    run "tee builtin" "$stages" "$(pipeline "$stages" "tee /dev/null")" --pipe-size "$PIPE_SIZE"
+    run "tee external" "$stages" "$(pipeline "$stages" "$TEE_BIN /dev/null")" --pipe-size "$PIPE_SIZE"
+done
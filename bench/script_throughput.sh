@@ -0,0 +1,49 @@
+#!/bin/bash
+
+# Пропускная способность чтения скриптов: строки/сек для файла из N команд.
+# Команды - только встроенные (cd/export/unset/set), чтобы измерялся разбор ввода, а не fork/exec.
+# Usage: ./script_throughput.sh <CustomShell binary> [lines]
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <CustomShell binary> [lines]"
+    echo "Example: $0 ../build/CustomShell 1000000"
+    exit 1
+fi
+
+SHELL_BIN=$1
+LINES=${2:-1000000}
+SCRIPT=$(mktemp /tmp/shell-script-XXXXXX)
+trap 'rm -f "$SCRIPT"' EXIT
+
+if [ ! -x "$SHELL_BIN" ]; then
+    echo "Error: $SHELL_BIN not found or not executable"
+    exit 1
+fi
+
+# awk генерирует 1M строк за доли секунды, в отличие от цикла с echo >>
+awk -v n="$LINES" 'BEGIN {
+    for (i = 0; i < n; i++) {
+        r = i % 4
+        if (r == 0) print "export BENCH_VAR=value" i
+        else if (r == 1) print "  cd   .  "
+        else if (r == 2) print "unset BENCH_VAR"
+        else print "set launch clone"
+    }
+}' > "$SCRIPT"
+
+run() {
+    local name=$1
+    shift
+    local start end elapsed_ms
+    start=$(date +%s%N)
+    "$@" > /dev/null
+    end=$(date +%s%N)
+    elapsed_ms=$(( (end - start) / 1000000 ))
+    [ "$elapsed_ms" -eq 0 ] && elapsed_ms=1
+    printf "%-12s %8d ms %12d lines/s\n" "$name" "$elapsed_ms" $(( LINES * 1000 / elapsed_ms ))
+}
+
+echo "Lines: $LINES"
+run "-f file" "$SHELL_BIN" -f "$SCRIPT"
+run "< file" sh -c "\"$SHELL_BIN\" < \"$SCRIPT\""
+run "pipe" sh -c "cat \"$SCRIPT\" | \"$SHELL_BIN\""
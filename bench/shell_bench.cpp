@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "lexer.h"
+#include "options.h"
+#include "process.h"
+#include "shell.h"
+#include "util.h"
+
+using namespace std;
+
+// Бенчмарк горячих путей шелла:
+//  1) запуск: launch + exec + wait, p50/p99 для clone3, posix_spawn и fork/vfork как базовых вариантов;
+//  2) токенизация строки: split() против Lexer;
+//  3) пропускная способность execute_pipeline для 2..16 стадий cat.
+// Usage: shell_bench [iterations] [rss_mb] [pipe_mb]
+// rss_mb - размер "балласта" в куче, имитирующего большой RSS супервизора.
+
+namespace {
+  using Clock = chrono::steady_clock;
+
+  double since(const Clock::time_point start) {
+    return chrono::duration<double>(Clock::now() - start).count();
+  }
+
+  const char *const kTrue = "/bin/true";
+
+  pid_t launch_fork(const bool use_vfork) {
+    char *argv[] = {const_cast<char *>(kTrue), nullptr};
+    const pid_t pid = use_vfork ? vfork() : fork();
+    if (pid == 0) {
+      execv(kTrue, argv);
+      _exit(127);
+    }
+    return pid;
+  }
+
+  void bench_spawn(const int iterations) {
+    char *argv[] = {const_cast<char *>(kTrue), nullptr};
+    LaunchSpec spec;
+    spec.argv = argv;
+    spec.path = kTrue;
+
+    const char *names[] = {"clone3", "spawn", "fork", "vfork"};
+    printf("\n%-8s %12s %10s %10s %10s\n", "launch", "spawns/s", "p50 us", "p99 us", "max us");
+    for (int variant = 0; variant < 4; ++variant) {
+      vector<double> latencies;
+      const int warmup = iterations / 10 + 1;
+      for (int i = 0; i < warmup + iterations; ++i) {
+        const auto start = Clock::now();
+        pid_t pid;
+        switch (variant) {
+          case 0: pid = launch_process(spec, LaunchMode::Clone); break;
+          case 1: pid = launch_process(spec, LaunchMode::Spawn); break;
+          default: pid = launch_fork(variant == 3); break;
+        }
+        if (pid == -1) {
+          perror(names[variant]);
+          exit(1);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        if (i >= warmup) {
+          latencies.push_back(since(start) * 1e6);
+        }
+      }
+      sort(latencies.begin(), latencies.end());
+      double total = 0;
+      for (const double latency : latencies) {
+        total += latency;
+      }
+      printf("%-8s %12.0f %10.1f %10.1f %10.1f\n", names[variant], latencies.size() / total * 1e6,
+             percentile(latencies, 50), percentile(latencies, 99), latencies.back());
+    }
+  }
+
+  void bench_tokenize() {
+    const string line = "grep -n --color=never pattern\\ with\\ spaces src/main.cpp src/shell.cpp > out.txt";
+    const int iterations = 1000000;
+    size_t tokens = 0;
+
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      tokens += split(line, ' ').size();
+    }
+    const double split_seconds = since(start);
+
+    Lexer lexer;
+    start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      tokens += lexer.tokenize(line).size();
+    }
+    const double lexer_seconds = since(start);
+
+    printf("\n%-8s %12s %10s %10s   (%zu-byte line, tokens %zu)\n", "tokenize", "lines/s", "ns/line", "MB/s",
+           line.size(), tokens);
+    for (const auto &[name, seconds] : {pair{"split", split_seconds}, pair{"lexer", lexer_seconds}}) {
+      printf("%-8s %12.0f %10.1f %10.1f\n", name, iterations / seconds, seconds * 1e9 / iterations,
+             iterations * line.size() / seconds / 1e6);
+    }
+  }
+
+  // head -c N /dev/zero | cat x (stages-2) | wc -c > /dev/null, через Lexer и execute_pipeline
+  double run_pipeline(Lexer &lexer, const int stages, const size_t pipe_mb) {
+    string line = "head -c " + to_string(pipe_mb) + "M /dev/zero";
+    for (int i = 2; i < stages; ++i) {
+      line += " | cat";
+    }
+    line += " | wc -c > /dev/null";
+
+    const auto start = Clock::now();
+    const auto commands = parse_pipeline(lexer.tokenize(line));
+    if (execute_pipeline(commands) != 0) {
+      fprintf(stderr, "pipeline failed: %s\n", line.c_str());
+      exit(1);
+    }
+    return since(start);
+  }
+
+  void bench_pipeline(const size_t pipe_mb) {
+    Lexer lexer;
+    printf("\n%-8s %-8s %10s %10s %10s   (%zu MiB through each pipeline, GB/s)\n", "pipeline", "launch", "default",
+           "1M pipes", "speedup", pipe_mb);
+    for (const int stages : {2, 4, 8, 16}) {
+      for (const LaunchMode mode : {LaunchMode::Clone, LaunchMode::Spawn}) {
+        shell_options.launch_mode = mode;
+        double throughput[2];
+        for (int i = 0; i < 2; ++i) {
+          shell_options.pipe_size = i == 0 ? 0 : 1 << 20;
+          run_pipeline(lexer, stages, pipe_mb / 8 + 1); // прогрев
+          throughput[i] = (pipe_mb << 20) / run_pipeline(lexer, stages, pipe_mb) / 1e9;
+        }
+        printf("%-8d %-8s %10.2f %10.2f %9.2fx\n", stages, launch_mode_name(mode), throughput[0], throughput[1],
+               throughput[1] / throughput[0]);
+      }
+    }
+    shell_options = ShellOptions{};
+  }
+}
+
+int main(int argc, char *argv[]) {
+  const int iterations = argc > 1 ? atoi(argv[1]) : 2000;
+  const size_t rss_mb = argc > 2 ? strtoul(argv[2], nullptr, 10) : 0;
+  const size_t pipe_mb = argc > 3 ? strtoul(argv[3], nullptr, 10) : 512;
+  if (iterations <= 0 || pipe_mb == 0) {
+    fprintf(stderr, "Usage: %s [iterations] [rss_mb] [pipe_mb]\n", argv[0]);
+    return 1;
+  }
+
+  // Касаемся каждой страницы, чтобы балласт действительно попал в RSS
+  vector<char> ballast(rss_mb << 20);
+  for (size_t i = 0; i < ballast.size(); i += 4096) {
+    ballast[i] = 1;
+  }
+
+  printf("iterations=%d rss=%zu MiB pipe=%zu MiB\n", iterations, rss_mb, pipe_mb);
+  bench_spawn(iterations);
+  bench_tokenize();
+  bench_pipeline(pipe_mb);
+  return 0;
+}
@@ -3,32 +3,101 @@
 #include <string.h>
 #include <unistd.h>
 #include <getopt.h>
+#include <errno.h>
 #include "crc.h"
+#include "crc_file.h"
+#include "crc_bench.h"
 
 void print_usage(const char *program_name) {
     printf("CPU Load Generator - CRC32 Calculator\n");
     printf("Usage: %s [OPTIONS]\n", program_name);
+    printf("       %s [OPTIONS] -f FILE [FILE...]\n", program_name);
+    printf("       %s --bench [--bench-max MB] [--samples N] > bench.csv\n", program_name);
     printf("Options:\n");
     printf("  -i, --iterations NUMBER  Number of CRC calculation iterations (default: 1000)\n");
     printf("  -s, --size SIZE          Data size in KB (default: 1024 = 1MB)\n");
+    printf("  -t, --threads NUMBER     Worker threads sharing the iterations, or each mmap window\n");
+    printf("                           with -f (default: 1)\n");
+    printf("  -c, --crc NAME           Checksum: crc32, crc32c (default: crc32)\n");
+    printf("  -k, --kernel NAME        Implementation: auto, byte, slice8, slice16, pclmul (crc32),\n");
+    printf("                           sse42 (crc32c) (default: auto - best one supported by the CPU)\n");
+    printf("  -f, --file PATH          Checksum files instead of the synthetic load; remaining\n");
+    printf("                           arguments are files too. Reports cold and warm page cache GB/s\n");
+    printf("  -r, --read MODE          File reading: mmap, pread (default: mmap)\n");
+    printf("  -b, --bench              Benchmark every supported kernel over buffer sizes from 4 KB\n");
+    printf("                           (L1) to --bench-max (DRAM); CSV with GB/s, stddev, cycles/byte\n");
+    printf("      --bench-max MB       Largest benchmark buffer (default: 128)\n");
+    printf("      --samples N          Timed samples per point after warm-up (default: 10)\n");
     printf("  -v, --verbose            Verbose output\n");
     printf("  -h, --help               Show this help message\n");
     printf("\n");
     printf("Examples:\n");
     printf("  %s -i 5000 -s 2048      # 5000 iterations with 2MB data\n", program_name);
     printf("  %s --iterations 10000   # 10000 iterations with default 1MB data\n", program_name);
+    printf("  %s -i 5000 -s 4000 -t 8 # 5000 iterations shared by 8 threads\n", program_name);
+    printf("  %s -c crc32c -f a.img b.img  # CRC32C of two files\n", program_name);
+}
+
+static double gb_per_sec(const CrcFileResult *result) {
+    return result->seconds > 0 ? result->bytes / result->seconds / 1e9 : 0;
+}
+
+// Контрольные суммы файлов: сначала с холодным page cache, затем повторно с тёплым
+static int checksum_files(const char **files, int count, CrcReadMode mode, int threads) {
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        CrcFileResult cold, warm;
+        int dropped = crc_file_drop_cache(files[i]) == 0;
+        if (crc_file(files[i], crc_variant, mode, threads, &cold) != 0 ||
+            crc_file(files[i], crc_variant, mode, threads, &warm) != 0) {
+            fprintf(stderr, "Error: cannot read %s: %s\n", files[i], strerror(errno));
+            failed = 1;
+            continue;
+        }
+        printf("%s: %s 0x%08X, %.1f MB, ", files[i], crc_variant_name(crc_variant), warm.crc,
+               warm.bytes / 1e6);
+        if (dropped) {
+            printf("cold %.2f GB/s, ", gb_per_sec(&cold));
+        } else {
+            printf("cold n/a, ");
+        }
+        printf("warm %.2f GB/s (%s)\n", gb_per_sec(&warm), crc_read_mode_name(mode));
+        if (cold.crc != warm.crc) {
+            fprintf(stderr, "Error: %s changed while reading\n", files[i]);
+            failed = 1;
+        }
+    }
+    return failed;
 }
 
 int main(int argc, char *argv[]) {
     int iterations = 1000;
     int data_size_kb = 1024; // 1MB по умолчанию
+    int threads = 1;
     int verbose = 0;
+    CrcKernel kernel = CRC_KERNEL_AUTO;
+    CrcReadMode read_mode = CRC_READ_MMAP;
+    int bench = 0;
+    CrcBenchOptions bench_options = crc_bench_defaults;
+    const char **files = malloc(argc * sizeof(char *));
+    int file_count = 0;
+    if (!files) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 1;
+    }
     
     // Парсинг аргументов командной строки
     static struct option long_options[] = {
         {"iterations", required_argument, 0, 'i'},
         {"size", required_argument, 0, 's'},
         {"threads", required_argument, 0, 't'},
+        {"crc", required_argument, 0, 'c'},
+        {"kernel", required_argument, 0, 'k'},
+        {"file", required_argument, 0, 'f'},
+        {"read", required_argument, 0, 'r'},
+        {"bench", no_argument, 0, 'b'},
+        {"bench-max", required_argument, 0, 'M'},
+        {"samples", required_argument, 0, 'S'},
         {"verbose", no_argument, 0, 'v'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
@@ -37,7 +106,7 @@ int main(int argc, char *argv[]) {
     int opt;
     int option_index = 0;
     
-    while ((opt = getopt_long(argc, argv, "i:s:t:vh", long_options, &option_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "i:s:t:c:k:f:r:bvh", long_options, &option_index)) != -1) {
         switch (opt) {
             case 'i':
                 iterations = atoi(optarg);
@@ -56,7 +125,56 @@ int main(int argc, char *argv[]) {
                 break;
                 
             case 't':
-                printf("Threading support coming soon. Using single thread.\n");
+                threads = atoi(optarg);
+                if (threads <= 0) {
+                    fprintf(stderr, "Error: threads must be positive\n");
+                    return 1;
+                }
+                break;
+                
+            case 'c':
+                if (!crc_variant_from_name(optarg, &crc_variant)) {
+                    fprintf(stderr, "Error: unknown checksum '%s' (expected crc32 or crc32c)\n", optarg);
+                    return 1;
+                }
+                break;
+                
+            case 'k':
+                if (!crc_kernel_from_name(optarg, &kernel)) {
+                    fprintf(stderr, "Error: unknown kernel '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+                
+            case 'f':
+                files[file_count++] = optarg;
+                break;
+                
+            case 'r':
+                if (!crc_read_mode_from_name(optarg, &read_mode)) {
+                    fprintf(stderr, "Error: unknown read mode '%s' (expected mmap or pread)\n", optarg);
+                    return 1;
+                }
+                break;
+                
+            case 'b':
+                bench = 1;
+                break;
+                
+            case 'M':
+                if (atoi(optarg) <= 0) {
+                    fprintf(stderr, "Error: benchmark size must be positive\n");
+                    return 1;
+                }
+                bench_options.max_size = (size_t)atoi(optarg) << 20;
+                break;
+                
+            case 'S':
+                bench_options.samples = atoi(optarg);
+                if (bench_options.samples <= 0) {
+                    fprintf(stderr, "Error: samples must be positive\n");
+                    return 1;
+                }
                 break;
                 
             case 'v':
@@ -73,23 +191,59 @@ int main(int argc, char *argv[]) {
         }
     }
     
+    // В режиме файлов остальные аргументы - тоже файлы
+    if (file_count > 0) {
+        while (optind < argc) {
+            files[file_count++] = argv[optind++];
+        }
+    }
+    if (optind < argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    init_crc32_table();
+    
+    if (!crc_set_kernel(crc_variant, kernel)) {
+        fprintf(stderr, "Error: kernel '%s' is not available for %s on this CPU\n",
+                crc_kernel_name(kernel), crc_variant_name(crc_variant));
+        return 1;
+    }
+    
+    // CSV идёт в stdout без заголовков конфигурации, чтобы его можно было перенаправить в файл
+    if (bench) {
+        free(files);
+        if (crc_bench(stdout, &bench_options) != 0) {
+            fprintf(stderr, "Error: cannot allocate %zu MB benchmark buffer\n", bench_options.max_size >> 20);
+            return 1;
+        }
+        return 0;
+    }
+    
     if (verbose) {
         printf("=== CPU Load Generator Configuration ===\n");
         printf("Iterations: %d\n", iterations);
         printf("Data size: %d KB (%zu bytes)\n", data_size_kb, (size_t)data_size_kb * 1024);
-        printf("Algorithm: CRC32 with lookup table\n");
+        printf("Threads: %d\n", threads);
+        printf("Algorithm: %s, kernel %s\n", crc_variant_name(crc_variant),
+               crc_kernel_name(crc_active_kernel(crc_variant)));
         printf("=======================================\n");
     }
     
-    init_crc32_table();
-    
     if (verbose) {
         printf("CRC table initialized\n");
     }
     
+    if (file_count > 0) {
+        int failed = checksum_files(files, file_count, read_mode, threads);
+        free(files);
+        return failed;
+    }
+    free(files);
+    
     // Запуск интенсивных вычислений
     size_t data_size_bytes = (size_t)data_size_kb * 1024;
-    intensive_crc_calculation(iterations, data_size_bytes);
+    intensive_crc_calculation(iterations, data_size_bytes, threads);
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,461 @@
+#include "crc.h"
+#include "crc_engine.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CRC_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+// C API поверх crc::Engine: таблицы берутся из .rodata движка, здесь только выбор
+// реализации по cpuid и аппаратные ядра
+
+CrcVariant crc_variant = CRC_VARIANT_CRC32;
+
+namespace {
+    const char *const kernel_names[] = {"auto", "byte", "slice8", "slice16", "pclmul", "sse42"};
+    const char *const variant_names[] = {"crc32", "crc32c"};
+
+    struct CpuFeatures {
+        bool pclmul = false;
+        bool sse42 = false;
+    };
+
+    const CpuFeatures &cpu() {
+        static const CpuFeatures features = [] {
+            CpuFeatures f;
+#ifdef CRC_X86
+            unsigned int eax, ebx, ecx, edx;
+            if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+                // PCLMUL-свёртке нужен ещё pextrd из SSE4.1
+                f.pclmul = (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1);
+                f.sse42 = (ecx & bit_SSE4_2) != 0;
+            }
+#endif
+            return f;
+        }();
+        return features;
+    }
+
+#ifdef CRC_X86
+    // Константы свёртки для отражённого полинома 0xEDB88320 (Intel, "Fast CRC Computation
+    // Using PCLMULQDQ"): x^(k) mod P для сдвигов на 512+-64, 128+-64 и 64 бита, плюс
+    // полином и mu для редукции Барретта
+    alignas(16) const uint64_t fold_k1k2[2] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) const uint64_t fold_k3k4[2] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) const uint64_t fold_k5k0[2] = {0x0163cd6124, 0x0000000000};
+    alignas(16) const uint64_t fold_poly[2] = {0x01db710641, 0x01f7011641};
+
+    // Свёртка блоков по 64 байта четырьмя 128-битными аккумуляторами; length >= 64 и кратна 16
+    __attribute__((target("pclmul,sse4.1")))
+    uint32_t crc32_fold_pclmul(uint32_t crc, const uint8_t *data, size_t length) {
+        __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+        x1 = _mm_loadu_si128((const __m128i *)(data + 0x00));
+        x2 = _mm_loadu_si128((const __m128i *)(data + 0x10));
+        x3 = _mm_loadu_si128((const __m128i *)(data + 0x20));
+        x4 = _mm_loadu_si128((const __m128i *)(data + 0x30));
+        x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+        x0 = _mm_load_si128((const __m128i *)fold_k1k2);
+        data += 64;
+        length -= 64;
+
+        while (length >= 64) {
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+            x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+            x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+            x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+            x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+            y5 = _mm_loadu_si128((const __m128i *)(data + 0x00));
+            y6 = _mm_loadu_si128((const __m128i *)(data + 0x10));
+            y7 = _mm_loadu_si128((const __m128i *)(data + 0x20));
+            y8 = _mm_loadu_si128((const __m128i *)(data + 0x30));
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+            x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+            x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+            x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+            data += 64;
+            length -= 64;
+        }
+
+        // Сводим четыре аккумулятора в один
+        x0 = _mm_load_si128((const __m128i *)fold_k3k4);
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+        while (length >= 16) {
+            x2 = _mm_loadu_si128((const __m128i *)data);
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+            data += 16;
+            length -= 16;
+        }
+
+        // 128 -> 64 бита
+        x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+        x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+        x1 = _mm_srli_si128(x1, 8);
+        x1 = _mm_xor_si128(x1, x2);
+        x0 = _mm_loadl_epi64((const __m128i *)fold_k5k0);
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_and_si128(x1, x3);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        // Редукция Барретта 64 -> 32 бита
+        x0 = _mm_load_si128((const __m128i *)fold_poly);
+        x2 = _mm_and_si128(x1, x3);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+        x2 = _mm_and_si128(x2, x3);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+        return (uint32_t)_mm_extract_epi32(x1, 1);
+    }
+
+    uint32_t crc32_update_pclmul(uint32_t crc, const uint8_t *data, size_t length) {
+        if (length >= 64) {
+            size_t folded = length & ~(size_t)15;
+            crc = crc32_fold_pclmul(crc, data, folded);
+            data += folded;
+            length -= folded;
+        }
+        return crc::Crc32::update_slice8(crc, data, length);
+    }
+
+    __attribute__((target("sse4.2")))
+    uint32_t crc32c_update_sse42(uint32_t crc, const uint8_t *data, size_t length) {
+#ifdef __x86_64__
+        uint64_t crc64 = crc;
+        while (length >= 8) {
+            uint64_t v;
+            memcpy(&v, data, sizeof(v));
+            crc64 = _mm_crc32_u64(crc64, v);
+            data += 8;
+            length -= 8;
+        }
+        crc = (uint32_t)crc64;
+#endif
+        while (length >= 4) {
+            uint32_t v;
+            memcpy(&v, data, sizeof(v));
+            crc = _mm_crc32_u32(crc, v);
+            data += 4;
+            length -= 4;
+        }
+        while (length > 0) {
+            crc = _mm_crc32_u8(crc, *data++);
+            length--;
+        }
+        return crc;
+    }
+#endif
+
+
+    // Лучшая доступная реализация: аппаратная, иначе slicing-by-16
+    CrcKernel best_kernel(CrcVariant variant) {
+        if (crc_kernel_supported(variant, CRC_KERNEL_PCLMUL)) {
+            return CRC_KERNEL_PCLMUL;
+        }
+        if (crc_kernel_supported(variant, CRC_KERNEL_SSE42)) {
+            return CRC_KERNEL_SSE42;
+        }
+        return CRC_KERNEL_SLICE16;
+    }
+
+    struct Dispatch {
+        CrcKernel kernel[2];
+        CrcUpdateFn update[2];
+    };
+
+    // Выбор по cpuid делается один раз, при первом обращении
+    Dispatch &dispatch() {
+        static Dispatch active = [] {
+            Dispatch d;
+            for (CrcVariant variant : {CRC_VARIANT_CRC32, CRC_VARIANT_CRC32C}) {
+                d.kernel[variant] = best_kernel(variant);
+                d.update[variant] = crc_kernel_update(variant, d.kernel[variant]);
+            }
+            return d;
+        }();
+        return active;
+    }
+} // namespace
+
+// Таблицы строятся при компиляции; функция оставлена для совместимости и лишь
+// заранее выбирает реализации
+void init_crc32_table() {
+    dispatch();
+}
+
+int crc_kernel_supported(CrcVariant variant, CrcKernel kernel) {
+    switch (kernel) {
+        case CRC_KERNEL_AUTO:
+        case CRC_KERNEL_BYTE:
+        case CRC_KERNEL_SLICE8:
+        case CRC_KERNEL_SLICE16:
+            return 1;
+        case CRC_KERNEL_PCLMUL:
+            return variant == CRC_VARIANT_CRC32 && cpu().pclmul;
+        case CRC_KERNEL_SSE42:
+            return variant == CRC_VARIANT_CRC32C && cpu().sse42;
+    }
+    return 0;
+}
+
+CrcUpdateFn crc_kernel_update(CrcVariant variant, CrcKernel kernel) {
+    if (!crc_kernel_supported(variant, kernel)) {
+        return nullptr;
+    }
+    if (kernel == CRC_KERNEL_AUTO) {
+        kernel = best_kernel(variant);
+    }
+    bool c = variant == CRC_VARIANT_CRC32C;
+    switch (kernel) {
+        case CRC_KERNEL_BYTE:
+            return c ? crc::Crc32c::update_byte : crc::Crc32::update_byte;
+        case CRC_KERNEL_SLICE8:
+            return c ? crc::Crc32c::update_slice8 : crc::Crc32::update_slice8;
+        case CRC_KERNEL_SLICE16:
+            return c ? crc::Crc32c::update_slice16 : crc::Crc32::update_slice16;
+#ifdef CRC_X86
+        case CRC_KERNEL_PCLMUL:
+            return crc32_update_pclmul;
+        case CRC_KERNEL_SSE42:
+            return crc32c_update_sse42;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+int crc_set_kernel(CrcVariant variant, CrcKernel kernel) {
+    CrcUpdateFn update = crc_kernel_update(variant, kernel);
+    if (!update) {
+        return 0;
+    }
+    dispatch().kernel[variant] = kernel == CRC_KERNEL_AUTO ? best_kernel(variant) : kernel;
+    dispatch().update[variant] = update;
+    return 1;
+}
+
+CrcKernel crc_active_kernel(CrcVariant variant) {
+    return dispatch().kernel[variant];
+}
+
+const char *crc_kernel_name(CrcKernel kernel) {
+    return kernel_names[kernel];
+}
+
+int crc_kernel_from_name(const char *name, CrcKernel *kernel) {
+    for (size_t i = 0; i < sizeof(kernel_names) / sizeof(kernel_names[0]); i++) {
+        if (strcmp(name, kernel_names[i]) == 0) {
+            *kernel = static_cast<CrcKernel>(i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+const char *crc_variant_name(CrcVariant variant) {
+    return variant_names[variant];
+}
+
+int crc_variant_from_name(const char *name, CrcVariant *variant) {
+    for (size_t i = 0; i < sizeof(variant_names) / sizeof(variant_names[0]); i++) {
+        if (strcmp(name, variant_names[i]) == 0) {
+            *variant = static_cast<CrcVariant>(i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Вычисление CRC32 выбранной реализацией
+uint32_t crc32(const uint8_t *data, size_t length) {
+    return crc::Crc32::finish(dispatch().update[CRC_VARIANT_CRC32](crc::Crc32::init(), data, length));
+}
+
+uint32_t crc32c(const uint8_t *data, size_t length) {
+    return crc::Crc32c::finish(dispatch().update[CRC_VARIANT_CRC32C](crc::Crc32c::init(), data, length));
+}
+
+uint32_t crc_compute(CrcVariant variant, const uint8_t *data, size_t length) {
+    return variant == CRC_VARIANT_CRC32C ? crc32c(data, length) : crc32(data, length);
+}
+
+uint64_t crc64(const uint8_t *data, size_t length) {
+    return crc::Crc64::compute(data, length);
+}
+
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, size_t length2) {
+    return crc::Crc32::combine(crc1, crc2, length2);
+}
+
+uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, size_t length2) {
+    return crc::Crc32c::combine(crc1, crc2, length2);
+}
+
+uint64_t crc64_combine(uint64_t crc1, uint64_t crc2, size_t length2) {
+    return crc::Crc64::combine(crc1, crc2, length2);
+}
+
+uint32_t crc_combine(CrcVariant variant, uint32_t crc1, uint32_t crc2, size_t length2) {
+    return variant == CRC_VARIANT_CRC32C ? crc32c_combine(crc1, crc2, length2)
+                                         : crc32_combine(crc1, crc2, length2);
+}
+
+void crc_init(CrcContext *ctx, CrcVariant variant) {
+    ctx->variant = variant;
+    ctx->state = variant == CRC_VARIANT_CRC32C ? crc::Crc32c::init() : crc::Crc32::init();
+    ctx->length = 0;
+}
+
+void crc_update(CrcContext *ctx, const uint8_t *data, size_t length) {
+    ctx->state = dispatch().update[ctx->variant](ctx->state, data, length);
+    ctx->length += length;
+}
+
+uint32_t crc_final(const CrcContext *ctx) {
+    return ctx->variant == CRC_VARIANT_CRC32C ? crc::Crc32c::finish(ctx->state) : crc::Crc32::finish(ctx->state);
+}
+
+void crc_update_parallel(CrcContext *ctx, const uint8_t *data, size_t length, int threads) {
+    if (threads <= 1) {
+        crc_update(ctx, data, length);
+        return;
+    }
+    // Итоговое значение переводится обратно в состояние тем же xor с xorout, что и finish
+    uint32_t crc = crc_combine(ctx->variant, crc_final(ctx), crc_parallel(ctx->variant, data, length, threads),
+                               length);
+    ctx->state = ctx->variant == CRC_VARIANT_CRC32C ? crc::Crc32c::finish(crc) : crc::Crc32::finish(crc);
+    ctx->length += length;
+}
+
+// Меньшие части не окупают запуск потока
+#define MIN_CHUNK (64 * 1024)
+
+uint32_t crc_parallel(CrcVariant variant, const uint8_t *data, size_t length, int threads) {
+    if (threads > 1 && length / threads < MIN_CHUNK) {
+        threads = static_cast<int>(length / MIN_CHUNK);
+    }
+    if (threads <= 1) {
+        return crc_compute(variant, data, length);
+    }
+
+    // Границы частей выровнены на 64 байта, чтобы не резать блоки свёртки
+    size_t chunk = (length / threads) & ~static_cast<size_t>(63);
+    std::vector<uint32_t> crcs(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads - 1; t++) {
+        workers.emplace_back([&, t] { crcs[t] = crc_compute(variant, data + t * chunk, chunk); });
+    }
+    size_t last = (threads - 1) * chunk;
+    crcs[threads - 1] = crc_compute(variant, data + last, length - last);
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    uint32_t crc = crcs[0];
+    for (int t = 1; t < threads; t++) {
+        crc = crc_combine(variant, crc, crcs[t], t == threads - 1 ? length - last : chunk);
+    }
+    return crc;
+}
+
+namespace {
+    struct IterationTask {
+        int index;
+        int iterations;
+        const uint8_t *source;
+        size_t data_size;
+        unsigned int seed;
+        uint32_t result;
+    };
+
+    // Итерации одного потока над своей копией данных
+    void iteration_worker(IterationTask *task) {
+        std::vector<uint8_t> test_data(task->source, task->source + task->data_size);
+
+        uint32_t result = 0;
+        for (int i = 0; i < task->iterations; i++) {
+            // Меняем немного данные для разнообразия вычислений
+            if (i % 100 == 0) {
+                test_data[rand_r(&task->seed) % task->data_size] = rand_r(&task->seed) % 256;
+            }
+
+            result ^= crc_compute(crc_variant, test_data.data(), task->data_size);
+
+            // Прогресс для длительных вычислений печатает только первый поток
+            if (task->index == 0 && task->iterations > 1000 && i % (task->iterations / 10) == 0) {
+                printf("Progress: %d%%\n", (i * 100) / task->iterations);
+            }
+        }
+        task->result = result;
+    }
+} // namespace
+
+// Интенсивные вычисления CRC
+void intensive_crc_calculation(int iterations, size_t data_size, int threads) {
+    printf("Starting CRC calculations...\n");
+    printf("Iterations: %d, Data size: %zu bytes, Threads: %d\n", iterations, data_size, threads);
+    
+    // Выделяем память для тестовых данных
+    std::vector<uint8_t> test_data(data_size);
+    
+    // Заполняем случайными данными
+    unsigned int seed = static_cast<unsigned int>(time(nullptr));
+    for (size_t i = 0; i < data_size; i++) {
+        test_data[i] = rand_r(&seed) % 256;
+    }
+    
+    // Итерации делятся между потоками поровну, у каждого своя копия данных
+    std::vector<IterationTask> tasks(threads);
+    for (int t = 0; t < threads; t++) {
+        tasks[t].index = t;
+        tasks[t].iterations = iterations / threads + (t < iterations % threads);
+        tasks[t].source = test_data.data();
+        tasks[t].data_size = data_size;
+        tasks[t].seed = seed + t;
+    }
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads - 1; t++) {
+        workers.emplace_back(iteration_worker, &tasks[t]);
+    }
+    iteration_worker(&tasks[threads - 1]);
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    
+    uint32_t final_result = 0;
+    for (int t = 0; t < threads; t++) {
+        final_result ^= tasks[t].result;
+    }
+    
+    printf("Final XOR result: 0x%08X\n", final_result);
+    if (threads > 1) {
+        // CRC исходного буфера по частям должна совпасть с однопоточной
+        uint32_t single = crc_compute(crc_variant, test_data.data(), data_size);
+        uint32_t chunked = crc_parallel(crc_variant, test_data.data(), data_size, threads);
+        printf("Chunked CRC check: 0x%08X (%d threads), 0x%08X (single thread) - %s\n",
+               chunked, threads, single, chunked == single ? "OK" : "MISMATCH");
+    }
+    printf("CRC calculations completed!\n");
+}
@@ -4,16 +4,84 @@
 #include <stdint.h>
 #include <stdlib.h>
 
-// CRC32 таблица для быстрых вычислений
-extern uint32_t crc32_table[256];
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-// Инициализация CRC таблицы
-void init_crc32_table();
+// Вариант контрольной суммы (--crc)
+typedef enum {
+    CRC_VARIANT_CRC32,    // полином 0xEDB88320 (zlib, Ethernet)
+    CRC_VARIANT_CRC32C,   // полином Castagnoli 0x82F63B78 (iSCSI, ext4)
+} CrcVariant;
+
+// Реализация вычисления (--kernel). Все реализации дают одинаковый результат
+typedef enum {
+    CRC_KERNEL_AUTO,      // лучшая доступная по cpuid
+    CRC_KERNEL_BYTE,      // побайтовая таблица (Sarwate)
+    CRC_KERNEL_SLICE8,    // slicing-by-8: 8 байт за шаг по 8 таблицам
+    CRC_KERNEL_SLICE16,   // slicing-by-16
+    CRC_KERNEL_PCLMUL,    // свёртка умножением без переносов (только CRC32)
+    CRC_KERNEL_SSE42,     // инструкция crc32 из SSE4.2 (только CRC32C)
+} CrcKernel;
+
+// Обновление "сырого" состояния CRC (без начальной и конечной инверсии)
+typedef uint32_t (*CrcUpdateFn)(uint32_t crc, const uint8_t *data, size_t length);
+
+// Вариант, который считает intensive_crc_calculation
+extern CrcVariant crc_variant;
+
+// Таблицы строятся при компиляции (crc_engine.h); выбор реализаций по cpuid делается при
+// первом вызове, init_crc32_table() лишь выполняет его заранее
+void init_crc32_table(void);
 
 // Вычисление CRC32 для данных
 uint32_t crc32(const uint8_t *data, size_t length);
+// Вычисление CRC32C для данных
+uint32_t crc32c(const uint8_t *data, size_t length);
+uint32_t crc_compute(CrcVariant variant, const uint8_t *data, size_t length);
+// Вычисление CRC-64/XZ (slicing-by-16)
+uint64_t crc64(const uint8_t *data, size_t length);
+
+// Объединение: по crc1 = CRC(A), crc2 = CRC(B) и длине B возвращает CRC(A || B)
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, size_t length2);
+uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, size_t length2);
+uint64_t crc64_combine(uint64_t crc1, uint64_t crc2, size_t length2);
+uint32_t crc_combine(CrcVariant variant, uint32_t crc1, uint32_t crc2, size_t length2);
+
+// CRC буфера, разрезанного на threads частей: части считаются в своих потоках и
+// объединяются crc_combine, результат совпадает с crc_compute
+uint32_t crc_parallel(CrcVariant variant, const uint8_t *data, size_t length, int threads);
+
+// Потоковое вычисление: crc_init, crc_update по частям, crc_final. Результат тот же, что
+// у crc_compute над всеми частями подряд
+typedef struct {
+    CrcVariant variant;
+    uint32_t state;     // "сырое" состояние
+    uint64_t length;    // обработано байт
+} CrcContext;
+
+void crc_init(CrcContext *ctx, CrcVariant variant);
+void crc_update(CrcContext *ctx, const uint8_t *data, size_t length);
+// То же, но большой блок считается по частям в threads потоках (crc_parallel)
+void crc_update_parallel(CrcContext *ctx, const uint8_t *data, size_t length, int threads);
+uint32_t crc_final(const CrcContext *ctx);
+
+// Выбор реализации; возвращает 0, если она недоступна для варианта или на этом процессоре
+int crc_set_kernel(CrcVariant variant, CrcKernel kernel);
+CrcKernel crc_active_kernel(CrcVariant variant);
+int crc_kernel_supported(CrcVariant variant, CrcKernel kernel);
+CrcUpdateFn crc_kernel_update(CrcVariant variant, CrcKernel kernel);
+
+const char *crc_kernel_name(CrcKernel kernel);
+int crc_kernel_from_name(const char *name, CrcKernel *kernel);
+const char *crc_variant_name(CrcVariant variant);
+int crc_variant_from_name(const char *name, CrcVariant *variant);
+
+// Интенсивное вычисление CRC с множеством итераций, поделённых между threads потоками
+void intensive_crc_calculation(int iterations, size_t data_size, int threads);
 
-// Интенсивное вычисление CRC с множеством итераций
-void intensive_crc_calculation(int iterations, size_t data_size);
+#ifdef __cplusplus
+}
+#endif
 
-#endif
\ No newline at end of file
+#endif
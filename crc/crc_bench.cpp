@@ -0,0 +1,184 @@
+#include "crc_bench.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <linux/perf_event.h>
+#include <new>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CRC_HAS_TSC 1
+#endif
+
+#include "crc.h"
+#include "crc_engine.h"
+
+const CrcBenchOptions crc_bench_defaults = {4 << 10, 128 << 20, 10};
+
+namespace {
+    // Замер повторяет CRC буфера, пока не наберёт столько байт: на маленьких буферах
+    // один проход короче разрешения таймера
+    constexpr size_t kSampleBytes = 32 << 20;
+    // Прогрев: столько же непосчитанных замеров - кэши, TLB, частота процессора
+    constexpr int kWarmupSamples = 2;
+    // Запись в volatile не даёт компилятору выбросить замеряемые вычисления
+    volatile uint64_t sink;
+
+    struct Candidate {
+        const char *crc;
+        const char *kernel;
+        CrcUpdateFn update; // nullptr - CRC-64 движка
+    };
+
+    uint64_t run(const Candidate &candidate, const uint8_t *data, size_t size) {
+        if (candidate.update == nullptr) {
+            return crc::Crc64::compute(data, size);
+        }
+        return ~candidate.update(0xFFFFFFFF, data, size);
+    }
+
+    // Счётчик тактов ядра через perf; если PMU недоступен (виртуалка, perf_event_paranoid) -
+    // TSC, то есть такты номинальной частоты
+    struct CycleCounter {
+        int fd = -1;
+
+        CycleCounter() {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        }
+
+        ~CycleCounter() {
+            if (fd != -1) {
+                close(fd);
+            }
+        }
+
+        const char *source() const {
+#ifdef CRC_HAS_TSC
+            return fd != -1 ? "perf" : "tsc";
+#else
+            return fd != -1 ? "perf" : "none";
+#endif
+        }
+
+        uint64_t read_cycles() const {
+            if (fd != -1) {
+                uint64_t value = 0;
+                if (read(fd, &value, sizeof(value)) == sizeof(value)) {
+                    return value;
+                }
+                return 0;
+            }
+#ifdef CRC_HAS_TSC
+            return __rdtsc();
+#else
+            return 0;
+#endif
+        }
+    };
+
+    double now() {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+
+    std::vector<Candidate> candidates() {
+        std::vector<Candidate> list;
+        for (CrcVariant variant : {CRC_VARIANT_CRC32, CRC_VARIANT_CRC32C}) {
+            for (CrcKernel kernel : {CRC_KERNEL_BYTE, CRC_KERNEL_SLICE8, CRC_KERNEL_SLICE16, CRC_KERNEL_PCLMUL,
+                                     CRC_KERNEL_SSE42}) {
+                if (crc_kernel_supported(variant, kernel)) {
+                    list.push_back({crc_variant_name(variant), crc_kernel_name(kernel),
+                                    crc_kernel_update(variant, kernel)});
+                }
+            }
+        }
+        list.push_back({"crc64", "slice16", nullptr});
+        return list;
+    }
+} // namespace
+
+int crc_bench(FILE *out, const CrcBenchOptions *options) {
+    std::vector<uint8_t> buffer;
+    try {
+        buffer.resize(options->max_size);
+    } catch (const std::bad_alloc &) {
+        errno = ENOMEM;
+        return -1;
+    }
+    // Случайные данные без rand(): xorshift с фиксированным seed, одинаковые между запусками
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (auto &byte : buffer) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        byte = static_cast<uint8_t>(x >> 32);
+    }
+
+    std::vector<size_t> sizes;
+    for (size_t size = options->min_size; size < options->max_size; size *= 4) {
+        sizes.push_back(size);
+    }
+    sizes.push_back(options->max_size);
+
+    CycleCounter counter;
+    fprintf(out, "crc,kernel,size_bytes,samples,bytes_per_sample,gbps_mean,gbps_stddev,gbps_min,gbps_max,"
+                 "cycles_per_byte,cycle_source,checksum\n");
+    for (const Candidate &candidate : candidates()) {
+        for (size_t size : sizes) {
+            const uint8_t *data = buffer.data();
+            size_t passes = std::max<size_t>(1, kSampleBytes / size);
+            std::vector<double> gbps;
+            double cycles = 0;
+            for (int sample = 0; sample < kWarmupSamples + options->samples; sample++) {
+                uint64_t cycles_start = counter.read_cycles();
+                double start = now();
+                uint64_t checksum = 0;
+                for (size_t pass = 0; pass < passes; pass++) {
+                    checksum ^= run(candidate, data, size);
+                }
+                sink = checksum;
+                double elapsed = now() - start;
+                uint64_t cycles_end = counter.read_cycles();
+                if (sample >= kWarmupSamples) {
+                    gbps.push_back(passes * size / elapsed / 1e9);
+                    cycles += static_cast<double>(cycles_end - cycles_start);
+                }
+            }
+
+            double mean = 0;
+            for (double value : gbps) {
+                mean += value;
+            }
+            mean /= gbps.size();
+            double variance = 0;
+            for (double value : gbps) {
+                variance += (value - mean) * (value - mean);
+            }
+            variance = gbps.size() > 1 ? variance / (gbps.size() - 1) : 0;
+            auto [min, max] = std::minmax_element(gbps.begin(), gbps.end());
+            double bytes = static_cast<double>(passes) * size * gbps.size();
+
+            // Контрольная сумма одинакова у всех реализаций одного CRC на одном размере
+            int digits = candidate.update == nullptr ? 16 : 8;
+            fprintf(out, "%s,%s,%zu,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%s,%0*llx\n", candidate.crc, candidate.kernel,
+                    size, gbps.size(), passes * size, mean, std::sqrt(variance), *min, *max, cycles / bytes,
+                    counter.source(), digits, static_cast<unsigned long long>(run(candidate, data, size)));
+            fflush(out);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef CRC_BENCH_H
+#define CRC_BENCH_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    size_t min_size;    // первый размер буфера (по умолчанию 4 KB - в L1)
+    size_t max_size;    // последний размер (по умолчанию 128 MB - заведомо в DRAM)
+    int samples;        // замеров на точку после прогрева
+} CrcBenchOptions;
+
+extern const CrcBenchOptions crc_bench_defaults;
+
+// Прогоняет все доступные реализации CRC32/CRC32C и CRC-64 по размерам буфера от min_size
+// до max_size (шаг x4) и пишет CSV в out: GB/s (среднее, отклонение, min, max) и тактов на
+// байт. Возвращает 0 или -1, если не хватило памяти под буфер
+int crc_bench(FILE *out, const CrcBenchOptions *options);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
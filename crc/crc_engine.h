@@ -0,0 +1,239 @@
+#ifndef CRC_ENGINE_H
+#define CRC_ENGINE_H
+
+// Табличный CRC, параметризованный как в каталоге reveng: ширина, полином в обычной
+// записи, отражение, init и xorout. Таблицы slicing-by-16 строятся при компиляции и
+// лежат в .rodata, поэтому инициализации при старте нет
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace crc {
+
+namespace detail {
+    template <unsigned Width>
+    using Value = std::conditional_t<(Width <= 32), uint32_t, uint64_t>;
+
+    template <unsigned Width>
+    using Tables = std::array<std::array<Value<Width>, 256>, 16>;
+
+    template <unsigned Width>
+    constexpr Value<Width> mask() {
+        if constexpr (Width == 64) {
+            return ~Value<Width>(0);
+        } else {
+            return Value<Width>((uint64_t(1) << Width) - 1);
+        }
+    }
+
+    template <unsigned Width>
+    constexpr Value<Width> reflect(Value<Width> value) {
+        Value<Width> result = 0;
+        for (unsigned i = 0; i < Width; i++) {
+            result = (result << 1) | ((value >> i) & 1);
+        }
+        return result;
+    }
+
+    // Сдвиг состояния на один нулевой байт по таблице t0
+    template <unsigned Width, bool Reflected>
+    constexpr Value<Width> shift_byte(const std::array<Value<Width>, 256> &t0, Value<Width> c) {
+        if constexpr (Reflected) {
+            return (c >> 8) ^ t0[c & 0xFF];
+        } else {
+            return ((c << 8) & mask<Width>()) ^ t0[c >> (Width - 8)];
+        }
+    }
+
+    // tables[k][i] - вклад байта i, за которым идут ещё k байт; tables[0] - обычная таблица
+    template <unsigned Width, bool Reflected>
+    constexpr Tables<Width> make_tables(Value<Width> poly) {
+        using V = Value<Width>;
+        constexpr V top = V(1) << (Width - 1);
+        Tables<Width> t{};
+        for (unsigned i = 0; i < 256; i++) {
+            V c;
+            if constexpr (Reflected) {
+                c = i;
+                for (int j = 0; j < 8; j++) {
+                    c = (c & 1) ? poly ^ (c >> 1) : c >> 1;
+                }
+            } else {
+                c = V(i) << (Width - 8);
+                for (int j = 0; j < 8; j++) {
+                    c = (c & top) ? ((c << 1) & mask<Width>()) ^ poly : (c << 1) & mask<Width>();
+                }
+            }
+            t[0][i] = c;
+        }
+        for (unsigned k = 1; k < 16; k++) {
+            for (unsigned i = 0; i < 256; i++) {
+                t[k][i] = shift_byte<Width, Reflected>(t[0], t[k - 1][i]);
+            }
+        }
+        return t;
+    }
+} // namespace detail
+
+template <unsigned Width, uint64_t Poly, bool Reflected, uint64_t Init, uint64_t XorOut>
+class Engine {
+    static_assert(Width >= 8 && Width <= 64 && Width % 8 == 0, "CRC width must be 8..64 bits, whole bytes");
+
+public:
+    using Value = detail::Value<Width>;
+
+    static constexpr unsigned kWidth = Width;
+    static constexpr Value kMask = detail::mask<Width>();
+    static constexpr Value kInit = Value(Init) & kMask;
+    static constexpr Value kXorOut = Value(XorOut) & kMask;
+    // Полином в той записи, в которой с ним работают сдвиги
+    static constexpr Value kPoly =
+            Reflected ? detail::reflect<Width>(Value(Poly) & kMask) : Value(Poly) & kMask;
+    static constexpr detail::Tables<Width> tables = detail::make_tables<Width, Reflected>(kPoly);
+
+    // Работа с "сырым" состоянием: state = init(), update(...)*, результат finish(state)
+    static constexpr Value init() { return kInit; }
+    static constexpr Value finish(Value state) { return (state ^ kXorOut) & kMask; }
+
+    static Value update_byte(Value crc, const uint8_t *data, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            if constexpr (Reflected) {
+                crc = (crc >> 8) ^ tables[0][(crc ^ data[i]) & 0xFF];
+            } else {
+                crc = ((crc << 8) & kMask) ^ tables[0][((crc >> (Width - 8)) ^ data[i]) & 0xFF];
+            }
+        }
+        return crc;
+    }
+
+    // 8 байт за шаг: состояние смешивается с началом слова, каждый байт слова сдвигается
+    // на оставшееся до конца шага расстояние своей таблицей
+    static Value update_slice8(Value crc, const uint8_t *data, size_t length) {
+        while (length >= 8) {
+            crc = fold_word<7>(load(data) ^ align_state(crc));
+            data += 8;
+            length -= 8;
+        }
+        return update_byte(crc, data, length);
+    }
+
+    static Value update_slice16(Value crc, const uint8_t *data, size_t length) {
+        while (length >= 16) {
+            crc = fold_word<15>(load(data) ^ align_state(crc)) ^ fold_word<7>(load(data + 8));
+            data += 16;
+            length -= 16;
+        }
+        return update_slice8(crc, data, length);
+    }
+
+    static Value compute(const uint8_t *data, size_t length) {
+        return finish(update_slice16(init(), data, length));
+    }
+
+    // CRC(A || B) по crc1 = CRC(A), crc2 = CRC(B) и длине B. Состояние после A сдвигается
+    // на length2 нулевых байт возведением в квадрат оператора "сдвиг на бит" над GF(2), как
+    // в zlib; init, вошедший в crc2, при этом сокращается
+    static Value combine(Value crc1, Value crc2, size_t length2) {
+        if (length2 == 0) {
+            return crc1;
+        }
+        Matrix odd = shift_one_bit();
+        Matrix even{};
+        square(even, odd); // 2 бита
+        square(odd, even); // 4 бита
+
+        Value state = crc1 ^ kXorOut ^ kInit;
+        do {
+            square(even, odd); // в первый раз - 1 байт
+            if (length2 & 1) {
+                state = times(even, state);
+            }
+            length2 >>= 1;
+            if (length2 == 0) {
+                break;
+            }
+            square(odd, even);
+            if (length2 & 1) {
+                state = times(odd, state);
+            }
+            length2 >>= 1;
+        } while (length2 != 0);
+        return (state ^ crc2) & kMask;
+    }
+
+private:
+    using Matrix = std::array<Value, Width>;
+
+    // Слово в порядке обработки: первый байт данных в младших битах для отражённого CRC,
+    // в старших - для обычного
+    static uint64_t load(const uint8_t *data) {
+        uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        constexpr bool swap = Reflected == (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+        return swap ? __builtin_bswap64(value) : value;
+    }
+
+    static uint64_t align_state(Value crc) {
+        if constexpr (Reflected) {
+            return crc;
+        } else {
+            return uint64_t(crc) << (64 - Width);
+        }
+    }
+
+    // j-й байт слова (в порядке данных) проходит через tables[Last - j]
+    template <unsigned Last>
+    static Value fold_word(uint64_t v) {
+        Value crc = 0;
+        for (unsigned j = 0; j < 8; j++) {
+            unsigned shift = Reflected ? 8 * j : 56 - 8 * j;
+            crc ^= tables[Last - j][(v >> shift) & 0xFF];
+        }
+        return crc;
+    }
+
+    // Образы битов состояния при сдвиге на один нулевой бит
+    static constexpr Matrix shift_one_bit() {
+        Matrix m{};
+        if constexpr (Reflected) {
+            m[0] = kPoly;
+            for (unsigned n = 1; n < Width; n++) {
+                m[n] = Value(1) << (n - 1);
+            }
+        } else {
+            for (unsigned n = 0; n + 1 < Width; n++) {
+                m[n] = Value(1) << (n + 1);
+            }
+            m[Width - 1] = kPoly;
+        }
+        return m;
+    }
+
+    static Value times(const Matrix &mat, Value vec) {
+        Value sum = 0;
+        for (unsigned n = 0; vec != 0; n++, vec >>= 1) {
+            if (vec & 1) {
+                sum ^= mat[n];
+            }
+        }
+        return sum;
+    }
+
+    static void square(Matrix &result, const Matrix &mat) {
+        for (unsigned n = 0; n < Width; n++) {
+            result[n] = times(mat, mat[n]);
+        }
+    }
+};
+
+// CRC-32 (zlib, Ethernet), CRC-32C (Castagnoli: iSCSI, ext4), CRC-64/XZ (ECMA-182)
+using Crc32 = Engine<32, 0x04C11DB7, true, 0xFFFFFFFF, 0xFFFFFFFF>;
+using Crc32c = Engine<32, 0x1EDC6F41, true, 0xFFFFFFFF, 0xFFFFFFFF>;
+using Crc64 = Engine<64, 0x42F0E1EBA9EA3693, true, 0xFFFFFFFFFFFFFFFF, 0xFFFFFFFFFFFFFFFF>;
+
+} // namespace crc
+
+#endif // CRC_ENGINE_H
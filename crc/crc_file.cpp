@@ -0,0 +1,199 @@
+#include "crc_file.h"
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    const char *const read_mode_names[] = {"mmap", "pread"};
+
+    // Окно mmap: его CRC считается, пока ядро читает следующее по MADV_WILLNEED
+    constexpr size_t kMapWindow = 64 << 20;
+    // Блок pread: достаточно большой, чтобы запросы уходили на диск целиком
+    constexpr size_t kReadBlock = 8 << 20;
+
+    double now() {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+
+    int crc_mmap(int fd, uint64_t size, int threads, CrcContext *ctx) {
+        if (size == 0) {
+            return 0;
+        }
+        void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            return -1;
+        }
+        const auto *data = static_cast<const uint8_t *>(map);
+        madvise(map, size, MADV_SEQUENTIAL);
+        for (uint64_t offset = 0; offset < size; offset += kMapWindow) {
+            size_t length = size - offset < kMapWindow ? size - offset : kMapWindow;
+            uint64_t next = offset + length;
+            if (next < size) {
+                size_t ahead = size - next < kMapWindow ? size - next : kMapWindow;
+                madvise(const_cast<uint8_t *>(data) + next, ahead, MADV_WILLNEED);
+            }
+            crc_update_parallel(ctx, data + offset, length, threads);
+            // Прочитанное окно отпускаем, чтобы RSS не рос до размера файла; page cache остаётся
+            madvise(const_cast<uint8_t *>(data) + offset, length, MADV_DONTNEED);
+        }
+        munmap(map, size);
+        return 0;
+    }
+
+    // Два буфера: поток чтения заполняет один, пока вызывающий поток считает CRC другого
+    struct ReadAhead {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<uint8_t> buffers[2];
+        size_t lengths[2] = {0, 0};
+        bool full[2] = {false, false};
+        bool stop = false;
+        int error = 0;
+    };
+
+    void read_blocks(int fd, ReadAhead *ahead) {
+        off_t offset = 0;
+        for (int slot = 0;; slot ^= 1) {
+            {
+                std::unique_lock<std::mutex> lock(ahead->mutex);
+                ahead->changed.wait(lock, [&] { return !ahead->full[slot] || ahead->stop; });
+                if (ahead->stop) {
+                    return;
+                }
+            }
+            size_t filled = 0;
+            int error = 0;
+            while (filled < kReadBlock) {
+                ssize_t n = pread(fd, ahead->buffers[slot].data() + filled, kReadBlock - filled, offset + filled);
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    error = errno;
+                    break;
+                }
+                if (n == 0) {
+                    break;
+                }
+                filled += n;
+            }
+            offset += filled;
+            std::lock_guard<std::mutex> lock(ahead->mutex);
+            ahead->lengths[slot] = filled;
+            ahead->full[slot] = true;
+            ahead->error = error;
+            ahead->changed.notify_all();
+            // Неполный блок - конец файла (или ошибка): пустой блок после него не нужен
+            if (filled < kReadBlock) {
+                return;
+            }
+        }
+    }
+
+    int crc_pread(int fd, CrcContext *ctx) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        ReadAhead ahead;
+        ahead.buffers[0].resize(kReadBlock);
+        ahead.buffers[1].resize(kReadBlock);
+        std::thread reader(read_blocks, fd, &ahead);
+
+        int error = 0;
+        for (int slot = 0;; slot ^= 1) {
+            size_t length;
+            {
+                std::unique_lock<std::mutex> lock(ahead.mutex);
+                ahead.changed.wait(lock, [&] { return ahead.full[slot]; });
+                length = ahead.lengths[slot];
+                error = ahead.error;
+            }
+            crc_update(ctx, ahead.buffers[slot].data(), length);
+
+            std::lock_guard<std::mutex> lock(ahead.mutex);
+            ahead.full[slot] = false;
+            if (length < kReadBlock || error != 0) {
+                ahead.stop = true;
+            }
+            ahead.changed.notify_all();
+            if (ahead.stop) {
+                break;
+            }
+        }
+        reader.join();
+        if (error != 0) {
+            errno = error;
+            return -1;
+        }
+        return 0;
+    }
+} // namespace
+
+int crc_file(const char *path, CrcVariant variant, CrcReadMode mode, int threads, CrcFileResult *result) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+
+    CrcContext ctx;
+    crc_init(&ctx, variant);
+    double start = now();
+    int status = mode == CRC_READ_MMAP ? crc_mmap(fd, st.st_size, threads, &ctx) : crc_pread(fd, &ctx);
+    double elapsed = now() - start;
+    int saved = errno;
+    close(fd);
+    if (status != 0) {
+        errno = saved;
+        return -1;
+    }
+
+    result->crc = crc_final(&ctx);
+    result->bytes = ctx.length;
+    result->seconds = elapsed;
+    return 0;
+}
+
+int crc_file_drop_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    fdatasync(fd);
+    int err = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    if (err != 0) {
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+const char *crc_read_mode_name(CrcReadMode mode) {
+    return read_mode_names[mode];
+}
+
+int crc_read_mode_from_name(const char *name, CrcReadMode *mode) {
+    for (size_t i = 0; i < sizeof(read_mode_names) / sizeof(read_mode_names[0]); i++) {
+        if (strcmp(name, read_mode_names[i]) == 0) {
+            *mode = static_cast<CrcReadMode>(i);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+#ifndef CRC_FILE_H
+#define CRC_FILE_H
+
+#include <stdint.h>
+
+#include "crc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Способ чтения файла (--read)
+typedef enum {
+    CRC_READ_MMAP,    // mmap + MADV_SEQUENTIAL, следующее окно заранее через MADV_WILLNEED
+    CRC_READ_PREAD,   // pread большими блоками в отдельном потоке, два буфера по очереди
+} CrcReadMode;
+
+typedef struct {
+    uint32_t crc;
+    uint64_t bytes;
+    double seconds;
+} CrcFileResult;
+
+// Контрольная сумма файла; threads > 1 считает окна mmap по частям (crc_update_parallel).
+// Возвращает 0 или -1 с errno
+int crc_file(const char *path, CrcVariant variant, CrcReadMode mode, int threads, CrcFileResult *result);
+
+// Выбрасывает страницы файла из page cache для холодного замера (fdatasync, затем
+// POSIX_FADV_DONTNEED); root не нужен. Возвращает 0 или -1 с errno
+int crc_file_drop_cache(const char *path);
+
+const char *crc_read_mode_name(CrcReadMode mode);
+int crc_read_mode_from_name(const char *name, CrcReadMode *mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
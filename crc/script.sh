@@ -3,54 +3,41 @@
 echo "=== Тестирование нагрузки CRC32 ==="
 
 # Проверка бинарника
-if [ ! -f "./cpu-calc-crc" ]; then
-    echo "Ошибка: файл cpu-calc-crc не найден"
-    echo "Сначала выполните: make cpu-calc-crc"
+if [ ! -f "./cpu-calc-crc-opt" ]; then
+    echo "Ошибка: файл cpu-calc-crc-opt не найден"
+    echo "Сначала выполните: make optimized"
     exit 1
 fi
 
-# Ввод количества инстансов
+# Ввод количества потоков (по умолчанию - число ядер)
 while true; do
-    read -p "Введите количество инстансов для запуска: " instances
-    if [[ "$instances" =~ ^[0-9]+$ ]] && [ "$instances" -ge 1 ]; then
+    read -p "Введите количество потоков [$(nproc)]: " threads
+    threads=${threads:-$(nproc)}
+    if [[ "$threads" =~ ^[0-9]+$ ]] && [ "$threads" -ge 1 ]; then
         break
     else
         echo "Ошибка: введите положительное число"
     fi
 done
 
-echo "=== Запуск $instances инстансов ==="
+# Один процесс с $threads потоками вместо отдельного процесса на ядро:
+# каждый поток выполняет свою долю из 5000 итераций на 4000 KB
+echo "=== Запуск: $threads потоков ==="
 
 start_time=$(date +%s%N)
 
-# Массив для хранения PID'ов
-pids=()
-
-# Запуск инстансов
-for ((i=1; i<=instances; i++)); do
-    echo "Запуск инстанса $i..."
-    ./cpu-calc-crc-opt -i 5000 -s 4000 $i &
-    pids+=($!)
-    echo "Инстанс $i запущен с PID: ${pids[-1]}"
-done
-
-echo "Все инстансы запущены, ожидание завершения..."
-
-# Ожидание завершения всех процессов
-for pid in "${pids[@]}"; do
-    wait $pid
-    status=$?
-    if [ $status -eq 0 ]; then
-        echo "Процесс $pid завершен успешно"
-    else
-        echo "Процесс $pid завершен с ошибкой: $status"
-    fi
-done
+./cpu-calc-crc-opt -i $((5000 * threads)) -s 4000 -t "$threads"
+status=$?
 
 end_time=$(date +%s%N)
 elapsed=$(( (end_time - start_time) / 1000000 ))
 
+if [ $status -ne 0 ]; then
+    echo "Процесс завершен с ошибкой: $status"
+    exit $status
+fi
+
 echo "=== Результаты ==="
-echo "Количество инстансов: $instances"
+echo "Количество потоков: $threads"
 echo "Общее время выполнения: ${elapsed}ms"
-echo "Среднее время на инстанс: $((elapsed / instances))ms"
\ No newline at end of file
+echo "Среднее время на поток: $((elapsed / threads))ms"
@@ -0,0 +1,143 @@
+#include "bintable.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "table.h"
+#include "util.h"
+
+#define CONVERT_CHUNK (1 << 20)  // строк за порцию при конвертации
+
+static uint64_t align_up(uint64_t value) {
+    return (value + BINTABLE_ALIGN - 1) & ~(uint64_t)(BINTABLE_ALIGN - 1);
+}
+
+int is_binary_table(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        return 0;
+    }
+    char magic[sizeof(((BinaryHeader *)0)->magic)];
+    ssize_t n = read(fd, magic, sizeof(magic));
+    close(fd);
+    return n == (ssize_t)sizeof(magic) && memcmp(magic, BINTABLE_MAGIC, sizeof(magic)) == 0;
+}
+
+void binary_table_open(BinaryTable *table, const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "Error: Cannot open file %s\n", filename);
+        exit(1);
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(BinaryHeader)) {
+        fprintf(stderr, "Error: Invalid binary table %s\n", filename);
+        close(fd);
+        exit(1);
+    }
+
+    table->length = st.st_size;
+    table->map = mmap(NULL, table->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (table->map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot mmap %s: %s\n", filename, strerror(errno));
+        exit(1);
+    }
+    // Колонки читаются один раз последовательно
+    madvise(table->map, table->length, MADV_SEQUENTIAL);
+
+    const BinaryHeader *header = table->map;
+    const char *base = table->map;
+    if (memcmp(header->magic, BINTABLE_MAGIC, sizeof(header->magic)) != 0 || header->version != 1 ||
+        header->word_size != BINTABLE_WORD || header->id_offset % BINTABLE_ALIGN != 0 ||
+        header->word_offset % BINTABLE_ALIGN != 0 ||
+        header->id_offset + header->rows * sizeof(int32_t) > table->length ||
+        header->word_offset + header->rows * BINTABLE_WORD > table->length) {
+        fprintf(stderr, "Error: Invalid binary table %s\n", filename);
+        exit(1);
+    }
+    table->rows = header->rows;
+    table->ids = (const int32_t *)(base + header->id_offset);
+    table->words = base + header->word_offset;
+}
+
+void binary_table_close(BinaryTable *table) {
+    munmap(table->map, table->length);
+    table->map = NULL;
+}
+
+static void pwrite_all(int fd, const void *data, size_t bytes, off_t offset, const char *filename) {
+    const char *p = data;
+    while (bytes > 0) {
+        ssize_t written = pwrite(fd, p, bytes, offset);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error: Cannot write %s: %s\n", filename, strerror(errno));
+            exit(1);
+        }
+        p += written;
+        offset += written;
+        bytes -= written;
+    }
+}
+
+void convert_text_table(const char *input, const char *output) {
+    TableReader reader;
+    table_reader_open(&reader, input);
+
+    // Число строк известно из заголовка, поэтому смещения колонок считаются заранее
+    // и каждая порция пишется сразу на своё место
+    BinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINTABLE_MAGIC, sizeof(header.magic));
+    header.version = 1;
+    header.word_size = BINTABLE_WORD;
+    header.rows = reader.size;
+    header.id_offset = align_up(sizeof(header));
+    header.word_offset = align_up(header.id_offset + header.rows * sizeof(int32_t));
+
+    int fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "Error: Cannot create file %s\n", output);
+        exit(1);
+    }
+    if (ftruncate(fd, header.word_offset + header.rows * BINTABLE_WORD) == -1) {
+        fprintf(stderr, "Error: Cannot resize %s: %s\n", output, strerror(errno));
+        exit(1);
+    }
+    pwrite_all(fd, &header, sizeof(header), 0, output);
+
+    Row *rows = checked_malloc(CONVERT_CHUNK * sizeof(Row));
+    int32_t *ids = checked_malloc(CONVERT_CHUNK * sizeof(int32_t));
+    char *words = checked_malloc(CONVERT_CHUNK * BINTABLE_WORD);
+
+    uint64_t done = 0;
+    size_t count;
+    while ((count = table_reader_next(&reader, rows, CONVERT_CHUNK)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            ids[i] = rows[i].id;
+            // strncpy дополняет нулями до 8 байт
+            strncpy(words + i * BINTABLE_WORD, rows[i].word, BINTABLE_WORD);
+        }
+        pwrite_all(fd, ids, count * sizeof(int32_t), header.id_offset + done * sizeof(int32_t), output);
+        pwrite_all(fd, words, count * BINTABLE_WORD, header.word_offset + done * BINTABLE_WORD, output);
+        done += count;
+    }
+
+    free(rows);
+    free(ids);
+    free(words);
+    table_reader_close(&reader);
+    if (close(fd) == -1) {
+        fprintf(stderr, "Error: Cannot write %s: %s\n", output, strerror(errno));
+        exit(1);
+    }
+}
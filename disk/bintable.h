@@ -0,0 +1,42 @@
+#ifndef BINTABLE_H
+#define BINTABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Бинарный колоночный формат таблицы:
+//   заголовок (64 байта) | id: int32[rows] | word: char[8][rows]
+// Каждая колонка начинается с границы 64 байт. Слово хранится ровно в 8 байтах,
+// короткие дополняются нулями. Файл отображается через mmap и читается без разбора.
+
+#define BINTABLE_MAGIC "EMAJOIN1"
+#define BINTABLE_ALIGN 64
+#define BINTABLE_WORD 8
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t word_size;
+    uint64_t rows;
+    uint64_t id_offset;
+    uint64_t word_offset;
+    uint8_t reserved[24];
+} BinaryHeader;
+
+typedef struct {
+    void *map;
+    size_t length;
+    uint64_t rows;
+    const int32_t *ids;
+    const char *words;  // rows * BINTABLE_WORD байт
+} BinaryTable;
+
+// Проверяет сигнатуру, не читая остальной файл
+int is_binary_table(const char *filename);
+void binary_table_open(BinaryTable *table, const char *filename);
+void binary_table_close(BinaryTable *table);
+
+// Конвертирует текстовую таблицу в бинарную потоково, порциями фиксированного размера
+void convert_text_table(const char *input, const char *output);
+
+#endif
@@ -3,249 +3,303 @@
 #include <string.h>
 #include <stdint.h>
 #include <time.h>
-
-#define WORD_SIZE 9  // 8 символов + 1 для '\0'
-
-typedef struct {
-    int id;
-    char word[WORD_SIZE];
-} Row;
-
-typedef struct {
-    int size;
-    Row *rows;
-} Table;
-
-// Функция сравнения для сортировки
-int compare_rows(const void *a, const void *b) {
-    const Row *row_a = (const Row *)a;
-    const Row *row_b = (const Row *)b;
-    return row_a->id - row_b->id;
-}
-
-// Чтение таблицы из файла
-Table read_table(const char *filename) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        fprintf(stderr, "Error: Cannot open file %s\n", filename);
-        exit(1);
-    }
-
-    Table table;
-    if (fscanf(file, "%d", &table.size) != 1) {
-        fprintf(stderr, "Error: Cannot read table size from %s\n", filename);
-        fclose(file);
-        exit(1);
-    }
-
-    table.rows = malloc(table.size * sizeof(Row));
-    if (!table.rows) {
-        fprintf(stderr, "Error: Memory allocation failed\n");
-        fclose(file);
-        exit(1);
+#include <getopt.h>
+
+#include "table.h"
+#include "bintable.h"
+#include "extsort.h"
+#include "generate.h"
+#include "join.h"
+#include "sort.h"
+#include "textparse.h"
+#include "util.h"
+#include "writer.h"
+
+// Размер в байтах с необязательным суффиксом K/M/G
+static int parse_size(const char *value, size_t *size) {
+    char *end;
+    unsigned long long parsed = strtoull(value, &end, 10);
+    if (end == value) {
+        return 0;
     }
-
-    for (int i = 0; i < table.size; i++) {
-        if (fscanf(file, "%d %8s", &table.rows[i].id, table.rows[i].word) != 2) {
-            fprintf(stderr, "Error: Cannot read row %d from %s\n", i, filename);
-            free(table.rows);
-            fclose(file);
-            exit(1);
-        }
+    switch (*end) {
+        case 'K': case 'k': parsed <<= 10; end++; break;
+        case 'M': case 'm': parsed <<= 20; end++; break;
+        case 'G': case 'g': parsed <<= 30; end++; break;
+        default: break;
     }
-
-    fclose(file);
-    return table;
+    *size = parsed;
+    return *end == '\0';
 }
 
-// Запись таблицы в файл
-void write_table(const char *filename, Table table) {
-    FILE *file = fopen(filename, "w");
-    if (!file) {
-        fprintf(stderr, "Error: Cannot create file %s\n", filename);
-        exit(1);
-    }
+// Число строк из заголовка, без чтения таблицы
+static long long table_rows(const char *filename) {
+    TableReader reader;
+    table_reader_open(&reader, filename);
+    long long rows = reader.size;
+    table_reader_close(&reader);
+    return rows;
+}
 
-    fprintf(file, "%d\n", table.size);
-    for (int i = 0; i < table.size; i++) {
-        fprintf(file, "%d %s\n", table.rows[i].id, table.rows[i].word);
+// Имя файла таблицы из шаблона: первое "%d" заменяется номером таблицы
+static void table_name(char *name, size_t size, const char *pattern, int index) {
+    const char *mark = strstr(pattern, "%d");
+    if (!mark) {
+        snprintf(name, size, "%s%d", pattern, index);
+    } else {
+        snprintf(name, size, "%.*s%d%s", (int)(mark - pattern), pattern, index, mark + 2);
     }
-
-    fclose(file);
 }
 
-// Sort-Merge Join алгоритм
-Table sort_merge_join(Table table1, Table table2) {
-    // Шаг 1: Сортируем обе таблицы по id
-    qsort(table1.rows, table1.size, sizeof(Row), compare_rows);
-    qsort(table2.rows, table2.size, sizeof(Row), compare_rows);
-
-    // Шаг 2: Подсчитываем размер результата
-    int result_size = 0;
-    int i = 0, j = 0;
-    
-    while (i < table1.size && j < table2.size) {
-        if (table1.rows[i].id < table2.rows[j].id) {
-            i++;
-        } else if (table1.rows[i].id > table2.rows[j].id) {
-            j++;
-        } else {
-            // Найдены совпадающие id
-            int current_id = table1.rows[i].id;
-            int count1 = 0, count2 = 0;
-            
-            // Подсчитываем количество строк с current_id в table1
-            int temp_i = i;
-            while (temp_i < table1.size && table1.rows[temp_i].id == current_id) {
-                count1++;
-                temp_i++;
-            }
-            
-            // Подсчитываем количество строк с current_id в table2
-            int temp_j = j;
-            while (temp_j < table2.size && table2.rows[temp_j].id == current_id) {
-                count2++;
-                temp_j++;
-            }
-            
-            result_size += count1 * count2;
-            i = temp_i;
-            j = temp_j;
-        }
-    }
+static void print_generate_usage(const char *program) {
+    printf("Usage: %s --generate <size1> <size2> [options]\n", program);
+    printf("Options:\n");
+    printf("  --dist NAME      Key distribution: uniform (default), zipf, seqdup, disjoint\n");
+    printf("  --keys N         Distinct keys (default: size / 2 + 1)\n");
+    printf("  --zipf S         Zipf exponent (default: 1.0)\n");
+    printf("  --seed N         Random seed (default: 42); equal seeds give identical tables\n");
+    printf("  --threads N      Generator threads (default: 1)\n");
+    printf("  --name PATTERN   Output names, %%d is the table number (default: table%%d.txt)\n");
+}
 
-    // Шаг 3: Выполняем join и создаем результирующую таблицу
-    Table result;
-    result.size = result_size;
-    result.rows = malloc(result_size * sizeof(Row));
-    if (!result.rows) {
-        fprintf(stderr, "Error: Memory allocation failed for result\n");
-        exit(1);
-    }
+// --generate: таблицы с заданным распределением ключей, воспроизводимые по seed
+static int generate_command(int argc, char *argv[], const char *program) {
+    static struct option generate_options[] = {
+        {"dist", required_argument, NULL, 'd'},
+        {"keys", required_argument, NULL, 'k'},
+        {"zipf", required_argument, NULL, 'z'},
+        {"seed", required_argument, NULL, 'S'},
+        {"threads", required_argument, NULL, 't'},
+        {"name", required_argument, NULL, 'n'},
+        {NULL, 0, NULL, 0}
+    };
 
-    int result_index = 0;
-    i = 0;
-    j = 0;
-
-    while (i < table1.size && j < table2.size) {
-        if (table1.rows[i].id < table2.rows[j].id) {
-            i++;
-        } else if (table1.rows[i].id > table2.rows[j].id) {
-            j++;
-        } else {
-            int current_id = table1.rows[i].id;
-            
-            // Находим границы блоков с одинаковым id в обеих таблицах
-            int start_i = i;
-            int start_j = j;
-            
-            while (i < table1.size && table1.rows[i].id == current_id) {
-                i++;
-            }
-            while (j < table2.size && table2.rows[j].id == current_id) {
-                j++;
-            }
-            
-            // Выполняем декартово произведение блоков
-            for (int k = start_i; k < i; k++) {
-                for (int l = start_j; l < j; l++) {
-                    result.rows[result_index].id = table1.rows[k].id;
-                    // Формируем объединенное слово (можно модифицировать по необходимости)
-                    snprintf(result.rows[result_index].word, WORD_SIZE, "%s", 
-                             table1.rows[k].word); // или комбинировать слова
-                    result_index++;
+    GenerateOptions options = generate_defaults;
+    const char *pattern = "table%d.txt";
+    const char *tmp_dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    int opt;
+    optind = 1;
+    while ((opt = getopt_long(argc, argv, "t:", generate_options, NULL)) != -1) {
+        switch (opt) {
+            case 'd':
+                if (!key_distribution_from_name(optarg, &options.distribution)) {
+                    fprintf(stderr, "Error: Unknown key distribution %s\n", optarg);
+                    return 1;
                 }
-            }
+                break;
+            case 'k':
+                options.keys = atoll(optarg);
+                break;
+            case 'z':
+                options.zipf_exponent = atof(optarg);
+                break;
+            case 'S':
+                options.seed = strtoull(optarg, NULL, 10);
+                break;
+            case 't':
+                options.threads = atoi(optarg);
+                break;
+            case 'n':
+                pattern = optarg;
+                break;
+            default:
+                print_generate_usage(program);
+                return 1;
         }
     }
-
-    return result;
-}
-
-// Генерация тестовых данных
-void generate_test_data(const char *filename, int size) {
-    FILE *file = fopen(filename, "w");
-    if (!file) {
-        fprintf(stderr, "Error: Cannot create file %s\n", filename);
-        exit(1);
+    if (argc - optind != 2 || options.keys < 0 || options.zipf_exponent <= 0 || options.threads <= 0) {
+        print_generate_usage(program);
+        return 1;
     }
 
-    fprintf(file, "%d\n", size);
-    
-    const char *words[] = {
-        "apple", "banana", "cherry", "date", "elder", "fig", "grape", "honey",
-        "ice", "juice", "kiwi", "lemon", "mango", "nut", "orange", "pear"
-    };
-    int words_count = sizeof(words) / sizeof(words[0]);
-
-    srand(time(NULL));
-    for (int i = 0; i < size; i++) {
-        int id = rand() % (size / 2 + 1); // Генерируем повторяющиеся id
-        const char *word = words[rand() % words_count];
-        fprintf(file, "%d %s\n", id, word);
+    long long sizes[2] = {atoll(argv[optind]), atoll(argv[optind + 1])};
+    char names[2][4096];
+    double start_time = now();
+    for (int t = 0; t < 2; t++) {
+        table_name(names[t], sizeof(names[t]), pattern, t + 1);
+        generate_table(names[t], sizes[t], t + 1, &options, tmp_dir);
     }
-
-    fclose(file);
-    printf("Generated test data: %s with %d rows\n", filename, size);
+    printf("Test files generated: %s (%lld rows), %s (%lld rows), %s keys, seed %llu, %.3f seconds\n",
+           names[0], sizes[0], names[1], sizes[1], key_distribution_name(options.distribution),
+           (unsigned long long)options.seed, now() - start_time);
+    return 0;
 }
 
-// Освобождение памяти таблицы
-void free_table(Table table) {
-    free(table.rows);
+static void print_usage(const char *program) {
+    printf("Usage:\n");
+    printf("  %s [--algo NAME] [--threads N] [--mem-limit SIZE] [--tmp-dir DIR] <table1_file> <table2_file> <output_file>\n", program);
+    printf("  %s --generate <size1> <size2> [--dist NAME] [--keys N] [--seed N] [--threads N]\n", program);
+    printf("  %s --convert <text_table> <binary_table>\n", program);
+    printf("Input tables may be text or binary (detected by signature).\n");
+    printf("The output file is a text table whose first line, the row count, is padded with spaces\n");
+    printf("to 20 characters, e.g. \"6                   \" (the count is only known after the join).\n");
+    printf("Options:\n");
+    printf("  --algo NAME       In-memory join: auto (default), sm, hash, radix-hash\n");
+    printf("  --threads N       Threads for the in-memory sort and merge (default: 1)\n");
+    printf("  --mem-limit SIZE  Memory budget (K/M/G suffix); larger inputs are joined externally\n");
+    printf("  --compact         Write one \"id left-range right-range\" line per matching key block\n");
+    printf("                    (row ranges of the sorted tables) instead of the expanded pairs\n");
+    printf("  --direct          Write the result with O_DIRECT, bypassing the page cache\n");
+    printf("  --tmp-dir DIR     Directory for sorted runs and per-thread result parts (default: $TMPDIR or /tmp)\n");
+    printf("  --parser NAME     Text table parser: auto (default), avx2, sse42, scalar, stdio\n");
+    printf("  --sort NAME       Sort algorithm: radix (default) or qsort\n");
+    printf("Example: %s table1.txt table2.txt result.txt\n", program);
+    printf("         %s -t 8 table1.txt table2.txt result.txt\n", program);
+    printf("         %s --mem-limit 256M big1.txt big2.txt result.txt\n", program);
+    printf("         %s --generate 1000 500\n", program);
+    printf("         %s --generate 1000000 1000000 --dist zipf --threads 4\n", program);
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 4 && argc != 2) {
-        printf("Usage:\n");
-        printf("  %s <table1_file> <table2_file> <output_file>\n", argv[0]);
-        printf("  %s --generate <size1> <size2>\n", argv[0]);
-        printf("Example: %s table1.txt table2.txt result.txt\n", argv[0]);
-        printf("         %s --generate 1000 500\n", argv[0]);
+    if (argc < 2) {
+        print_usage(argv[0]);
         return 1;
     }
 
     if (strcmp(argv[1], "--generate") == 0) {
+        return generate_command(argc - 1, argv + 1, argv[0]);
+    }
+
+    if (strcmp(argv[1], "--convert") == 0) {
         if (argc != 4) {
-            printf("Usage: %s --generate <size1> <size2>\n", argv[0]);
+            printf("Usage: %s --convert <text_table> <binary_table>\n", argv[0]);
             return 1;
         }
-        
-        int size1 = atoi(argv[2]);
-        int size2 = atoi(argv[3]);
-        
-        generate_test_data("table1.txt", size1);
-        generate_test_data("table2.txt", size2);
-        
-        printf("Test files generated: table1.txt (%d rows), table2.txt (%d rows)\n", size1, size2);
+
+        clock_t start_time = clock();
+        const char *tmp_dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+        convert_text_table(table_spool(argv[2], tmp_dir), argv[3]);
+        printf("Converted %s -> %s in %.3f seconds\n", argv[2], argv[3],
+               ((double)(clock() - start_time)) / CLOCKS_PER_SEC);
         return 0;
     }
 
+    static struct option long_options[] = {
+        {"mem-limit", required_argument, NULL, 'm'},
+        {"tmp-dir", required_argument, NULL, 'T'},
+        {"parser", required_argument, NULL, 'p'},
+        {"sort", required_argument, NULL, 's'},
+        {"threads", required_argument, NULL, 't'},
+        {"algo", required_argument, NULL, 'a'},
+        {"direct", no_argument, NULL, 'D'},
+        {"compact", no_argument, NULL, 'C'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    size_t mem_limit = 0;  // 0 - без ограничения, таблицы целиком в памяти
+    const char *tmp_dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    int threads = 1;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "m:T:p:s:t:a:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'm':
+                if (!parse_size(optarg, &mem_limit) || mem_limit == 0) {
+                    fprintf(stderr, "Error: Invalid memory limit %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'T':
+                tmp_dir = optarg;
+                break;
+            case 'p':
+                if (!text_parser_from_name(optarg, &text_parser_kind)) {
+                    fprintf(stderr, "Error: Unknown parser %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 's':
+                if (!sort_algorithm_from_name(optarg, &sort_algorithm)) {
+                    fprintf(stderr, "Error: Unknown sort algorithm %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 't':
+                threads = atoi(optarg);
+                if (threads <= 0) {
+                    fprintf(stderr, "Error: Invalid thread count %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'a':
+                if (!join_algorithm_from_name(optarg, &join_algorithm)) {
+                    fprintf(stderr, "Error: Unknown join algorithm %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'C':
+                join_compact = 1;
+                break;
+            case 'D':
+                output_direct = 1;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (argc - optind != 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const char *output = argv[optind + 2];
+
     // Измеряем время выполнения
-    clock_t start_time = clock();
+    double start_time = now();
+
+    // Пайпы копируются на диск: таблица открывается дважды (table_rows и само соединение),
+    // а в память целиком не читается при любом --mem-limit
+    const char *file1 = table_spool(argv[optind], tmp_dir);
+    const char *file2 = table_spool(argv[optind + 1], tmp_dir);
+
+    // Таблицы, не помещающиеся в mem_limit, обрабатываются во внешней памяти
+    long long rows1 = table_rows(file1);
+    long long rows2 = table_rows(file2);
+    if (mem_limit > 0 && ((size_t)rows1 + rows2) * sizeof(Row) > mem_limit) {
+        printf("Table1: %lld rows\n", rows1);
+        printf("Table2: %lld rows\n", rows2);
+        printf("External mode: memory limit %zu bytes, temporary files in %s\n", mem_limit, tmp_dir);
+        // Внешнее соединение - однопоточный потоковый sort-merge
+        if (threads > 1) {
+            fprintf(stderr, "Warning: external mode is single-threaded, ignoring --threads %d\n", threads);
+        }
+        if (join_algorithm != JOIN_AUTO && join_algorithm != JOIN_SORT_MERGE) {
+            fprintf(stderr, "Warning: external mode uses sort-merge, ignoring --algo %s\n",
+                    join_algorithm_name(join_algorithm));
+        }
 
-    // Чтение входных таблиц
-    Table table1 = read_table(argv[1]);
-    Table table2 = read_table(argv[2]);
+        long long result_size = external_sort_merge_join(file1, file2, output, mem_limit, tmp_dir);
+
+        double execution_time = now() - start_time;
+        printf("Join completed successfully!\n");
+        printf("Result: %lld rows %swritten to %s\n", result_size, join_compact ? "(as compact blocks) " : "",
+               output);
+        printf("Execution time: %.3f seconds\n", execution_time);
+        return 0;
+    }
 
-    printf("Table1: %d rows\n", table1.size);
-    printf("Table2: %d rows\n", table2.size);
+    // Чтение входных таблиц
+    Table table1 = read_table(file1);
+    Table table2 = read_table(file2);
 
-    // Выполнение Sort-Merge Join
-    Table result = sort_merge_join(table1, table2);
+    printf("Table1: %lld rows\n", table1.size);
+    printf("Table2: %lld rows\n", table2.size);
 
-    // Запись результата
-    write_table(argv[3], result);
+    // Выполнение соединения (Sort-Merge Join или hash join, см. --algo);
+    // результат пишется в файл потоком, не накапливаясь в памяти
+    long long result_size = join_tables(table1, table2, join_algorithm, threads, output, tmp_dir);
 
     // Освобождение памяти
     free_table(table1);
     free_table(table2);
-    free_table(result);
 
-    clock_t end_time = clock();
-    double execution_time = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
+    double execution_time = now() - start_time;
 
     printf("Join completed successfully!\n");
-    printf("Result: %d rows written to %s\n", result.size, argv[3]);
+    printf("Result: %lld rows %swritten to %s\n", result_size, join_compact ? "(as compact blocks) " : "", output);
     printf("Execution time: %.3f seconds\n", execution_time);
 
     return 0;
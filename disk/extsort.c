@@ -0,0 +1,243 @@
+#include "extsort.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sort.h"
+#include "util.h"
+
+#define MIN_RUN_BUFFER (64 * 1024)  // с меньшим буфером слияние упирается в число системных вызовов
+#define MAX_FAN_IN 256              // заодно держит число открытых файлов в разумных пределах
+
+static size_t read_full(int fd, void *data, size_t bytes) {
+    char *p = data;
+    size_t total = 0;
+    while (total < bytes) {
+        ssize_t n = read(fd, p + total, bytes - total);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error: Cannot read temporary file: %s\n", strerror(errno));
+            exit(1);
+        }
+        if (n == 0) {
+            break;
+        }
+        total += n;
+    }
+    return total;
+}
+
+static void rewind_run(int fd) {
+    if (lseek(fd, 0, SEEK_SET) == -1) {
+        fprintf(stderr, "Error: Cannot rewind temporary file: %s\n", strerror(errno));
+        exit(1);
+    }
+}
+
+// Фаза 1: порции по mem_limit байт сортируются в памяти и сбрасываются в runs.
+// Radix sort нужен буфер того же размера, поэтому порция вдвое меньше
+static int *create_runs(const char *filename, size_t mem_limit, const char *tmp_dir, int *count) {
+    int radix = sort_algorithm == SORT_RADIX;
+    size_t capacity = mem_limit / sizeof(Row) / (radix ? 2 : 1);
+    if (capacity < 1024) {
+        capacity = 1024;
+    }
+    Row *buffer = checked_malloc(capacity * sizeof(Row));
+    Row *scratch = radix ? checked_malloc(capacity * sizeof(Row)) : NULL;
+
+    TableReader reader;
+    table_reader_open(&reader, filename);
+
+    int *fds = NULL;
+    int runs = 0;
+    int runs_capacity = 0;
+    size_t rows;
+    while ((rows = table_reader_next(&reader, buffer, capacity)) > 0) {
+        if (radix) {
+            radix_sort_rows(buffer, rows, scratch);
+        } else {
+            qsort(buffer, rows, sizeof(Row), compare_rows);
+        }
+        int fd = create_temp_file(tmp_dir);
+        write_all(fd, buffer, rows * sizeof(Row), "temporary file");
+        rewind_run(fd);
+
+        if (runs == runs_capacity) {
+            runs_capacity = runs_capacity ? runs_capacity * 2 : 16;
+            fds = checked_realloc(fds, runs_capacity * sizeof(int));
+        }
+        fds[runs++] = fd;
+    }
+
+    table_reader_close(&reader);
+    free(buffer);
+    free(scratch);
+    *count = runs;
+    return fds;
+}
+
+static int run_fill(RunReader *run) {
+    run->len = read_full(run->fd, run->buffer, run->cap * sizeof(Row)) / sizeof(Row);
+    run->pos = 0;
+    return run->len > 0;
+}
+
+// При равных id раньше идёт run с меньшим номером: слияние сохраняет порядок входа
+static int run_less(const MergeStream *stream, int a, int b) {
+    int id_a = stream->runs[a].buffer[stream->runs[a].pos].id;
+    int id_b = stream->runs[b].buffer[stream->runs[b].pos].id;
+    return id_a < id_b || (id_a == id_b && a < b);
+}
+
+static void sift_down(MergeStream *stream, int i) {
+    int *heap = stream->heap;
+    while (1) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < stream->heap_size && run_less(stream, heap[left], heap[smallest])) {
+            smallest = left;
+        }
+        if (right < stream->heap_size && run_less(stream, heap[right], heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+        int tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+// Фаза 2: буферы чтения делят memory поровну между runs
+static void merge_stream_init(MergeStream *stream, const int *fds, int count, size_t memory) {
+    size_t capacity = count > 0 ? memory / count / sizeof(Row) : 0;
+    if (capacity < 256) {
+        capacity = 256;
+    }
+    stream->count = count;
+    stream->heap_size = 0;
+    stream->runs = checked_malloc((count > 0 ? count : 1) * sizeof(RunReader));
+    stream->heap = checked_malloc((count > 0 ? count : 1) * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        RunReader *run = &stream->runs[i];
+        run->fd = fds[i];
+        run->cap = capacity;
+        run->buffer = checked_malloc(capacity * sizeof(Row));
+        if (run_fill(run)) {
+            stream->heap[stream->heap_size++] = i;
+        }
+    }
+    for (int i = stream->heap_size / 2 - 1; i >= 0; i--) {
+        sift_down(stream, i);
+    }
+}
+
+const Row *merge_stream_peek(const MergeStream *stream) {
+    if (stream->heap_size == 0) {
+        return NULL;
+    }
+    const RunReader *run = &stream->runs[stream->heap[0]];
+    return &run->buffer[run->pos];
+}
+
+void merge_stream_next(MergeStream *stream) {
+    RunReader *run = &stream->runs[stream->heap[0]];
+    if (++run->pos == run->len && !run_fill(run)) {
+        stream->heap[0] = stream->heap[--stream->heap_size];
+    }
+    if (stream->heap_size > 0) {
+        sift_down(stream, 0);
+    }
+}
+
+void merge_stream_close(MergeStream *stream) {
+    for (int i = 0; i < stream->count; i++) {
+        close(stream->runs[i].fd);
+        free(stream->runs[i].buffer);
+    }
+    free(stream->runs);
+    free(stream->heap);
+    stream->runs = NULL;
+    stream->heap = NULL;
+    stream->count = stream->heap_size = 0;
+}
+
+// Промежуточный проход: сливает count runs в один новый
+static int merge_to_run(const int *fds, int count, size_t memory, const char *tmp_dir) {
+    MergeStream stream;
+    merge_stream_init(&stream, fds, count, memory / 2);
+
+    size_t capacity = memory / 2 / sizeof(Row);
+    if (capacity < 1024) {
+        capacity = 1024;
+    }
+    Row *out = checked_malloc(capacity * sizeof(Row));
+    int fd = create_temp_file(tmp_dir);
+    size_t rows = 0;
+    const Row *row;
+    while ((row = merge_stream_peek(&stream)) != NULL) {
+        out[rows++] = *row;
+        merge_stream_next(&stream);
+        if (rows == capacity) {
+            write_all(fd, out, rows * sizeof(Row), "temporary file");
+            rows = 0;
+        }
+    }
+    write_all(fd, out, rows * sizeof(Row), "temporary file");
+    rewind_run(fd);
+
+    merge_stream_close(&stream);
+    free(out);
+    return fd;
+}
+
+static int fan_in_for(size_t memory) {
+    size_t fan_in = memory / MIN_RUN_BUFFER;
+    if (fan_in < 2) {
+        return 2;
+    }
+    return fan_in > MAX_FAN_IN ? MAX_FAN_IN : (int)fan_in;
+}
+
+void merge_stream_open(MergeStream *stream, SortedRuns *runs, size_t memory) {
+    merge_stream_init(stream, runs->fds, runs->count, memory);
+    free(runs->fds);
+    runs->fds = NULL;
+    runs->count = 0;
+}
+
+void external_sort(const char *filename, size_t mem_limit, size_t stream_memory, const char *tmp_dir,
+                   SortedRuns *runs) {
+    int count;
+    int *fds = create_runs(filename, mem_limit, tmp_dir, &count);
+    printf("%s: %d sorted runs\n", filename, count);
+
+    // Финальный поток получает только stream_memory, поэтому может понадобиться
+    // несколько проходов, пока runs не станет не больше его fan-in
+    int fan_in = fan_in_for(stream_memory);
+    int merge_fan_in = fan_in_for(mem_limit / 2);
+    int passes = 0;
+    while (count > fan_in) {
+        int merged = 0;
+        for (int i = 0; i < count; i += merge_fan_in) {
+            int group = count - i < merge_fan_in ? count - i : merge_fan_in;
+            fds[merged++] = group == 1 ? fds[i] : merge_to_run(fds + i, group, mem_limit, tmp_dir);
+        }
+        count = merged;
+        passes++;
+    }
+    if (passes > 0) {
+        printf("%s: %d intermediate merge passes, %d runs left\n", filename, passes, count);
+    }
+
+    runs->fds = fds;
+    runs->count = count;
+}
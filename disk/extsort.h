@@ -0,0 +1,47 @@
+#ifndef EXTSORT_H
+#define EXTSORT_H
+
+#include <stddef.h>
+
+#include "table.h"
+
+// Внешняя сортировка для таблиц больше памяти. Таблица читается порциями по mem_limit байт,
+// каждая порция сортируется и сбрасывается во временный файл (run); затем runs сливаются
+// k-way слиянием через кучу. Если runs больше, чем позволяет память на буферы, сначала
+// выполняются промежуточные проходы слияния.
+
+// Буфер чтения одного run
+typedef struct {
+    int fd;
+    Row *buffer;
+    size_t pos;
+    size_t len;
+    size_t cap;
+} RunReader;
+
+// Отсортированные runs таблицы; дескрипторы открыты и перемотаны в начало
+typedef struct {
+    int *fds;
+    int count;
+} SortedRuns;
+
+// Отсортированный поток строк таблицы поверх слияния runs
+typedef struct {
+    RunReader *runs;
+    int *heap;       // индексы runs, упорядоченные по id текущей строки
+    int heap_size;
+    int count;
+} MergeStream;
+
+// Режет таблицу из filename на отсортированные runs, используя не больше mem_limit байт, и сливает
+// их промежуточными проходами, пока runs не хватит stream_memory байт на буферы финального слияния
+void external_sort(const char *filename, size_t mem_limit, size_t stream_memory, const char *tmp_dir,
+                   SortedRuns *runs);
+// Открывает финальное слияние; stream забирает дескрипторы runs
+void merge_stream_open(MergeStream *stream, SortedRuns *runs, size_t memory);
+// Текущая минимальная строка или NULL, если поток исчерпан
+const Row *merge_stream_peek(const MergeStream *stream);
+void merge_stream_next(MergeStream *stream);
+void merge_stream_close(MergeStream *stream);
+
+#endif
@@ -0,0 +1,201 @@
+#include "generate.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "table.h"
+#include "util.h"
+#include "workers.h"
+#include "writer.h"
+
+#define CHUNK_ROWS (1 << 16)
+
+const GenerateOptions generate_defaults = {DIST_UNIFORM, 0, 1.0, 42, 1};
+
+static const char *const distribution_names[] = {"uniform", "zipf", "seqdup", "disjoint"};
+
+static const char *const words[] = {
+    "apple", "banana", "cherry", "date", "elder", "fig", "grape", "honey",
+    "ice", "juice", "kiwi", "lemon", "mango", "nut", "orange", "pear"
+};
+
+// Параметры выборки Ципфа методом rejection-inversion (Hörmann, Derflinger): O(1) на значение
+// без таблицы вероятностей, поэтому число ключей не ограничено памятью
+typedef struct {
+    double s;
+    double n;
+    double h_integral_x1;
+    double h_integral_n;
+    double threshold;
+} ZipfSampler;
+
+typedef struct {
+    const GenerateOptions *options;
+    const ZipfSampler *zipf;
+    long long keys;
+    int table_index;
+    long long begin;   // строки [begin, end), границы кратны CHUNK_ROWS
+    long long end;
+    RowWriter *writer;
+} GenerateTask;
+
+// splitmix64: быстрый генератор с хорошим перемешиванием, годится и для выработки seed
+static inline uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline double next_double(uint64_t *state) {
+    return (next_random(state) >> 11) * 0x1.0p-53;
+}
+
+// Равномерно в [0, bound) умножением вместо деления
+static inline uint64_t next_below(uint64_t *state, uint64_t bound) {
+    return (uint64_t)(((unsigned __int128)next_random(state) * bound) >> 64);
+}
+
+// log1p(x) / x и expm1(x) / x с пределом 1 в нуле
+static double helper1(double x) {
+    return fabs(x) > 1e-8 ? log1p(x) / x : 1 - x / 2;
+}
+
+static double helper2(double x) {
+    return fabs(x) > 1e-8 ? expm1(x) / x : 1 + x / 2;
+}
+
+static double zipf_h(const ZipfSampler *z, double x) {
+    return exp(-z->s * log(x));
+}
+
+static double zipf_h_integral(const ZipfSampler *z, double x) {
+    double log_x = log(x);
+    return helper2((1 - z->s) * log_x) * log_x;
+}
+
+static double zipf_h_integral_inverse(const ZipfSampler *z, double x) {
+    double t = x * (1 - z->s);
+    if (t < -1) {
+        t = -1;
+    }
+    return exp(helper1(t) * x);
+}
+
+static void zipf_init(ZipfSampler *z, long long n, double s) {
+    z->s = s;
+    z->n = (double)n;
+    z->h_integral_x1 = zipf_h_integral(z, 1.5) - 1;
+    z->h_integral_n = zipf_h_integral(z, z->n + 0.5);
+    z->threshold = 2 - zipf_h_integral_inverse(z, zipf_h_integral(z, 2.5) - zipf_h(z, 2));
+}
+
+// Ранг от 1 до n
+static long long zipf_sample(const ZipfSampler *z, uint64_t *state) {
+    while (1) {
+        double u = z->h_integral_n + next_double(state) * (z->h_integral_x1 - z->h_integral_n);
+        double x = zipf_h_integral_inverse(z, u);
+        long long k = (long long)(x + 0.5);
+        if (k < 1) {
+            k = 1;
+        } else if (k > z->n) {
+            k = (long long)z->n;
+        }
+        if (k - x <= z->threshold || u >= zipf_h_integral(z, k + 0.5) - zipf_h(z, k)) {
+            return k;
+        }
+    }
+}
+
+static void *generate_rows(void *arg) {
+    GenerateTask *task = arg;
+    const GenerateOptions *options = task->options;
+    uint64_t state = 0;
+    Row row;
+    memset(&row, 0, sizeof(row));
+
+    for (long long i = task->begin; i < task->end; i++) {
+        if (i % CHUNK_ROWS == 0 || i == task->begin) {
+            // Свой поток случайных чисел у каждой порции каждой таблицы
+            uint64_t chunk = (uint64_t)(i / CHUNK_ROWS);
+            state = options->seed ^ ((uint64_t)task->table_index << 56) ^ (chunk * 0xD6E8FEB86659FD93ULL);
+            next_random(&state);
+        }
+        switch (options->distribution) {
+            case DIST_ZIPF:
+                row.id = (int)(zipf_sample(task->zipf, &state) - 1);
+                break;
+            case DIST_SEQDUP:
+                row.id = (int)(i % task->keys);
+                break;
+            case DIST_DISJOINT:
+                row.id = (int)(2 * next_below(&state, task->keys) + (task->table_index - 1));
+                break;
+            default:
+                row.id = (int)next_below(&state, task->keys);
+                break;
+        }
+        strcpy(row.word, words[next_random(&state) & 15]);
+        row_writer_put(task->writer, &row);
+    }
+    return NULL;
+}
+
+void generate_table(const char *filename, long long rows, int table_index, const GenerateOptions *options,
+                    const char *tmp_dir) {
+    long long keys = options->keys > 0 ? options->keys : rows / 2 + 1;
+    long long max_keys = options->distribution == DIST_DISJOINT ? 1LL << 30 : 1LL << 31;
+    if (rows < 0 || rows > 2147483647LL || keys > max_keys) {
+        fprintf(stderr, "Error: Too many rows or keys for %s\n", filename);
+        exit(1);
+    }
+
+    ZipfSampler zipf;
+    memset(&zipf, 0, sizeof(zipf));
+    if (options->distribution == DIST_ZIPF) {
+        zipf_init(&zipf, keys, options->zipf_exponent);
+    }
+
+    // Поток t пишет свой отрезок строк: поток 0 - прямо в файл, остальные - во временные файлы,
+    // которые затем дописываются по порядку
+    long long chunks = (rows + CHUNK_ROWS - 1) / CHUNK_ROWS;
+    int threads = options->threads > 1 ? options->threads : 1;
+    if (threads > chunks) {
+        threads = chunks > 0 ? (int)chunks : 1;
+    }
+    RowWriter *writers = checked_malloc(threads * sizeof(RowWriter));
+    GenerateTask *tasks = checked_malloc(threads * sizeof(GenerateTask));
+    row_writer_open(&writers[0], filename);
+    for (int t = 0; t < threads; t++) {
+        if (t > 0) {
+            row_writer_open_temp(&writers[t], tmp_dir);
+        }
+        long long end = chunks * (t + 1) / threads * CHUNK_ROWS;
+        tasks[t] = (GenerateTask){options, &zipf, keys, table_index, chunks * t / threads * CHUNK_ROWS,
+                                  end < rows ? end : rows, &writers[t]};
+    }
+    run_workers(generate_rows, tasks, sizeof(GenerateTask), threads);
+
+    for (int t = 1; t < threads; t++) {
+        row_writer_append(&writers[0], &writers[t]);
+    }
+    row_writer_close(&writers[0]);
+    free(writers);
+    free(tasks);
+}
+
+const char *key_distribution_name(KeyDistribution distribution) {
+    return distribution_names[distribution];
+}
+
+int key_distribution_from_name(const char *name, KeyDistribution *distribution) {
+    for (size_t i = 0; i < sizeof(distribution_names) / sizeof(distribution_names[0]); i++) {
+        if (strcmp(name, distribution_names[i]) == 0) {
+            *distribution = (KeyDistribution)i;
+            return 1;
+        }
+    }
+    return 0;
+}
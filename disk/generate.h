@@ -0,0 +1,34 @@
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include <stdint.h>
+
+// Генерация тестовых таблиц. Результат определяется только seed и параметрами: строки
+// делятся на порции фиксированного размера, у каждой порции свой поток случайных чисел,
+// поэтому число потоков на содержимое не влияет
+
+typedef enum {
+    DIST_UNIFORM,    // равномерно из keys значений
+    DIST_ZIPF,       // по закону Ципфа: id 0 самый частый
+    DIST_SEQDUP,     // последовательные id по кругу: i % keys
+    DIST_DISJOINT,   // равномерно, но у table1 чётные id, у table2 нечётные - пустой результат
+} KeyDistribution;
+
+typedef struct {
+    KeyDistribution distribution;
+    long long keys;         // число различных id; 0 - rows / 2 + 1, как у прежнего генератора
+    double zipf_exponent;
+    uint64_t seed;
+    int threads;
+} GenerateOptions;
+
+extern const GenerateOptions generate_defaults;
+
+// table_index (1 или 2) выбирает независимый поток случайных чисел и половину для DIST_DISJOINT
+void generate_table(const char *filename, long long rows, int table_index, const GenerateOptions *options,
+                    const char *tmp_dir);
+
+const char *key_distribution_name(KeyDistribution distribution);
+int key_distribution_from_name(const char *name, KeyDistribution *distribution);
+
+#endif
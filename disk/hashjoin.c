@@ -0,0 +1,269 @@
+#include "hashjoin.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "join.h"
+#include "util.h"
+#include "workers.h"
+#include "writer.h"
+
+#define MAX_PARTITION_BITS 14
+#define DEFAULT_L2_SIZE (256 * 1024)
+#define INITIAL_SLOT_BITS 8
+
+typedef struct {
+    int32_t key;
+    uint32_t count;   // 0 - свободный слот
+    uint64_t start;   // первая строка ключа в сгруппированном массиве
+} HashSlot;
+
+typedef struct {
+    HashSlot *slots;
+    size_t mask;
+    int shift;        // сдвиг хеша к битам слота; старшие биты заняты номером раздела
+    int partition_bits;
+    Row *rows;        // строки, сгруппированные по ключам; NULL, если нужны только счётчики
+} HashTable;
+
+// Проба одной частью большой таблицы; результат - в собственный выход потока
+typedef struct {
+    const HashTable *table;
+    const Row *probe;
+    size_t probe_count;
+    int build_left;   // таблица построена по table1: строки результата берутся из неё
+    RowWriter *writer;
+} ProbeTask;
+
+// Поток radix-варианта обрабатывает разделы first, first + step, ... со своими хеш-таблицами
+typedef struct {
+    const Row *build;
+    const size_t *build_offsets;
+    const Row *probe;
+    const size_t *probe_offsets;
+    int first;
+    int step;
+    int partition_bits;
+    int build_left;
+    RowWriter *writer;
+} PartitionTask;
+
+// Мультипликативный хеш; старшие биты лучше перемешаны, поэтому раздел берётся из самых
+// старших, а слот - из следующих за ними
+static inline uint64_t hash_key(int32_t key) {
+    return (uint64_t)(uint32_t)key * 0x9E3779B97F4A7C15ULL;
+}
+
+int hash_join_partition_bits(size_t build_count) {
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (l2 <= 0) {
+        l2 = DEFAULT_L2_SIZE;
+    }
+    // На строку построения приходится сама строка и до двух слотов (заполнение <= 1/2)
+    size_t per_row = sizeof(Row) + 2 * sizeof(HashSlot);
+    int bits = 0;
+    while (bits < MAX_PARTITION_BITS && (build_count >> bits) * per_row > (size_t)l2) {
+        bits++;
+    }
+    return bits;
+}
+
+static inline HashSlot *hash_table_find(const HashTable *table, int32_t key) {
+    size_t index = (hash_key(key) >> table->shift) & table->mask;
+    while (table->slots[index].count != 0 && table->slots[index].key != key) {
+        index = (index + 1) & table->mask;
+    }
+    return &table->slots[index];
+}
+
+// partition_bits - сколько старших бит хеша уже ушло на номер раздела
+static void hash_table_alloc(HashTable *table, int slot_bits, int partition_bits) {
+    table->mask = ((size_t)1 << slot_bits) - 1;
+    table->partition_bits = partition_bits;
+    table->shift = 64 - partition_bits - slot_bits;
+    table->slots = checked_calloc(table->mask + 1, sizeof(HashSlot));
+}
+
+// Удвоение: ключи со счётчиками переносятся в новую таблицу
+static void hash_table_grow(HashTable *table) {
+    HashSlot *old = table->slots;
+    size_t old_size = table->mask + 1;
+    hash_table_alloc(table, __builtin_ctzll(old_size) + 1, table->partition_bits);
+    for (size_t s = 0; s < old_size; s++) {
+        if (old[s].count != 0) {
+            *hash_table_find(table, old[s].key) = old[s];
+        }
+    }
+    free(old);
+}
+
+static void hash_table_build(HashTable *table, const Row *rows, size_t count, int group_rows,
+                             int partition_bits) {
+    // Таблица растёт при заполнении больше половины, поэтому её размер определяется числом
+    // различных ключей, а не строк: при тяжёлых дубликатах она остаётся в кэше
+    hash_table_alloc(table, INITIAL_SLOT_BITS, partition_bits);
+    size_t used = 0;
+    for (size_t i = 0; i < count; i++) {
+        HashSlot *slot = hash_table_find(table, rows[i].id);
+        if (slot->count == 0) {
+            if (++used * 2 > table->mask + 1) {
+                hash_table_grow(table);
+                slot = hash_table_find(table, rows[i].id);
+            }
+            slot->key = rows[i].id;
+        }
+        slot->count++;
+    }
+
+    table->rows = NULL;
+    if (!group_rows) {
+        return;
+    }
+
+    // Группировка: start сначала указывает на конец группы, строки раскладываются с конца,
+    // так что порядок внутри группы сохраняется, а start в итоге указывает на её начало
+    uint64_t offset = 0;
+    for (size_t s = 0; s <= table->mask; s++) {
+        offset += table->slots[s].count;
+        table->slots[s].start = offset;
+    }
+    table->rows = checked_malloc(count * sizeof(Row));
+    for (size_t i = count; i-- > 0;) {
+        HashSlot *slot = hash_table_find(table, rows[i].id);
+        table->rows[--slot->start] = rows[i];
+    }
+}
+
+static void hash_table_free(HashTable *table) {
+    free(table->slots);
+    free(table->rows);
+}
+
+static void *probe_range(void *arg) {
+    ProbeTask *task = arg;
+    const HashTable *table = task->table;
+
+    for (size_t i = 0; i < task->probe_count; i++) {
+        const HashSlot *slot = hash_table_find(table, task->probe[i].id);
+        if (slot->count == 0) {
+            continue;
+        }
+        if (task->build_left) {
+            for (uint64_t k = slot->start; k < slot->start + slot->count; k++) {
+                row_writer_put(task->writer, &table->rows[k]);
+            }
+        } else {
+            row_writer_put_repeat(task->writer, &task->probe[i], slot->count);
+        }
+    }
+    return NULL;
+}
+
+static void *join_partitions(void *arg) {
+    PartitionTask *task = arg;
+    int parts = 1 << task->partition_bits;
+    for (int p = task->first; p < parts; p += task->step) {
+        const Row *build = task->build + task->build_offsets[p];
+        size_t build_count = task->build_offsets[p + 1] - task->build_offsets[p];
+        HashTable table;
+        hash_table_build(&table, build, build_count, task->build_left, task->partition_bits);
+
+        ProbeTask probe = {&table, task->probe + task->probe_offsets[p],
+                           task->probe_offsets[p + 1] - task->probe_offsets[p], task->build_left,
+                           task->writer};
+        probe_range(&probe);
+        hash_table_free(&table);
+    }
+    return NULL;
+}
+
+// Раскладывает строки по разделам (старшие bits бит хеша) с сохранением порядка;
+// offsets получает parts + 1 границу
+static Row *partition_rows(const Row *rows, size_t count, int bits, size_t *offsets) {
+    size_t parts = (size_t)1 << bits;
+    memset(offsets, 0, (parts + 1) * sizeof(size_t));
+    for (size_t i = 0; i < count; i++) {
+        offsets[(hash_key(rows[i].id) >> (64 - bits)) + 1]++;
+    }
+    for (size_t p = 0; p < parts; p++) {
+        offsets[p + 1] += offsets[p];
+    }
+
+    Row *out = checked_malloc(count * sizeof(Row));
+    size_t *cursor = checked_malloc(parts * sizeof(size_t));
+    memcpy(cursor, offsets, parts * sizeof(size_t));
+    for (size_t i = 0; i < count; i++) {
+        out[cursor[hash_key(rows[i].id) >> (64 - bits)]++] = rows[i];
+    }
+    free(cursor);
+    return out;
+}
+
+// Без разбиения: одна общая хеш-таблица, большая таблица делится между потоками на части
+static void simple_hash_join(const Row *build, size_t build_count, const Row *probe,
+                             size_t probe_count, int build_left, JoinOutput *out) {
+    HashTable table;
+    hash_table_build(&table, build, build_count, build_left, 0);
+
+    int threads = out->count;
+    ProbeTask *tasks = checked_malloc(threads * sizeof(ProbeTask));
+    for (int t = 0; t < threads; t++) {
+        size_t begin = probe_count * t / threads;
+        size_t end = probe_count * (t + 1) / threads;
+        tasks[t] = (ProbeTask){&table, probe + begin, end - begin, build_left, &out->writers[t]};
+    }
+    run_workers(probe_range, tasks, sizeof(ProbeTask), threads);
+
+    free(tasks);
+    hash_table_free(&table);
+}
+
+// Radix-вариант: обе таблицы разбиваются по старшим битам хеша, разделы обрабатываются
+// независимо, каждый поток берёт свою долю разделов
+static void partitioned_hash_join(const Row *build, size_t build_count, const Row *probe,
+                                  size_t probe_count, int build_left, int bits, JoinOutput *out) {
+    int parts = 1 << bits;
+    size_t *build_offsets = checked_malloc((parts + 1) * sizeof(size_t));
+    size_t *probe_offsets = checked_malloc((parts + 1) * sizeof(size_t));
+    Row *build_parts = partition_rows(build, build_count, bits, build_offsets);
+    Row *probe_parts = partition_rows(probe, probe_count, bits, probe_offsets);
+
+    int threads = out->count;
+    PartitionTask *tasks = checked_malloc(threads * sizeof(PartitionTask));
+    for (int t = 0; t < threads; t++) {
+        tasks[t] = (PartitionTask){build_parts, build_offsets, probe_parts, probe_offsets,
+                                   t, threads, bits, build_left, &out->writers[t]};
+    }
+    run_workers(join_partitions, tasks, sizeof(PartitionTask), threads);
+
+    free(tasks);
+    free(build_parts);
+    free(probe_parts);
+    free(build_offsets);
+    free(probe_offsets);
+}
+
+long long hash_join(Table table1, Table table2, int partitioned, int threads, const char *output,
+                    const char *tmp_dir) {
+    // Строим по меньшей таблице; если это table2, строки результата берутся из пробы
+    int build_left = table1.size <= table2.size;
+    const Table *build = build_left ? &table1 : &table2;
+    const Table *probe = build_left ? &table2 : &table1;
+    int bits = partitioned ? hash_join_partition_bits(build->size) : 0;
+
+    double start = now();
+    JoinOutput out;
+    join_output_open(&out, output, threads, tmp_dir);
+    if (bits > 0) {
+        partitioned_hash_join(build->rows, build->size, probe->rows, probe->size, build_left, bits, &out);
+    } else {
+        simple_hash_join(build->rows, build->size, probe->rows, probe->size, build_left, &out);
+    }
+    long long result_size = join_output_close(&out);
+    printf("Hash join (build on table%d, %d partitions, %d threads): %.3f seconds\n",
+           build_left ? 1 : 2, 1 << bits, out.count, now() - start);
+    return result_size;
+}
@@ -0,0 +1,20 @@
+#ifndef HASHJOIN_H
+#define HASHJOIN_H
+
+#include <stddef.h>
+
+#include "table.h"
+
+// Hash join: хеш-таблица строится по меньшей таблице, большая проходит по ней пробами.
+// Открытая адресация с линейным пробированием; в слоте хранится ключ и диапазон его строк
+// в массиве, где строки построения сгруппированы по ключам, поэтому дубликаты читаются подряд
+
+// Сколько бит хеша нужно на разделы, чтобы хеш-таблица раздела помещалась в L2 (0 - не нужно)
+int hash_join_partition_bits(size_t build_count);
+
+// partitioned - radix-разбиение обеих таблиц на разделы размером с L2 перед построением.
+// Результат пишется в output потоком; возвращает число строк результата
+long long hash_join(Table table1, Table table2, int partitioned, int threads, const char *output,
+                    const char *tmp_dir);
+
+#endif
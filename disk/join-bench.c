@@ -0,0 +1,238 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "util.h"
+
+// Воспроизводимый набор замеров соединения. Для каждого размера 10^k из [min, max] и каждого
+// распределения ключей генерирует пару таблиц (ema-join-sm-opt --generate с фиксированным seed),
+// по умолчанию переводит их в бинарный формат и запускает соединение каждым алгоритмом.
+// На каждый запуск печатается строка CSV: время, входных строк в секунду, пиковый RSS процесса
+// (wait4) и число строк результата.
+// Usage: join-bench [options] [-- extra join options]
+
+#define MAX_ARGS 64
+
+// Запускает программу с выводом в /dev/null; возвращает время и пиковый RSS в KB
+static double run(char *const args[], long *peak_rss) {
+    double start = now();
+    pid_t pid = fork();
+    if (pid == -1) {
+        fprintf(stderr, "Error: fork failed: %s\n", strerror(errno));
+        exit(1);
+    }
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        if (null != -1) {
+            dup2(null, STDOUT_FILENO);
+        }
+        execv(args[0], args);
+        fprintf(stderr, "Error: Cannot run %s: %s\n", args[0], strerror(errno));
+        _exit(127);
+    }
+
+    int status;
+    struct rusage usage;
+    while (wait4(pid, &status, 0, &usage) == -1) {
+        if (errno != EINTR) {
+            fprintf(stderr, "Error: wait4 failed: %s\n", strerror(errno));
+            exit(1);
+        }
+    }
+    double elapsed = now() - start;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "Error: Command failed:");
+        for (int i = 0; args[i]; i++) {
+            fprintf(stderr, " %s", args[i]);
+        }
+        fprintf(stderr, "\n");
+        exit(1);
+    }
+    *peak_rss = usage.ru_maxrss;
+    return elapsed;
+}
+
+static long long result_rows(const char *filename) {
+    FILE *file = fopen(filename, "r");
+    long long rows = -1;
+    if (file) {
+        if (fscanf(file, "%lld", &rows) != 1) {
+            rows = -1;
+        }
+        fclose(file);
+    }
+    return rows;
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options] [-- extra join options]\n", program);
+    printf("Options:\n");
+    printf("  --program PATH   Join binary (default: ./ema-join-sm-opt)\n");
+    printf("  --min N          Smallest table size, rounded to a power of 10 (default: 1000)\n");
+    printf("  --max N          Largest table size (default: 1000000000)\n");
+    printf("  --dist LIST      Key distributions (default: uniform,zipf,seqdup,disjoint)\n");
+    printf("  --algo LIST      Join algorithms (default: sm,hash,radix-hash)\n");
+    printf("  --zipf S         Zipf exponent (default: 0.5, keeps the result near linear)\n");
+    printf("  --threads N      Threads for the generator and the join (default: 1)\n");
+    printf("  --repeats N      Runs per configuration (default: 1)\n");
+    printf("  --format NAME    Input format: binary (default) or text\n");
+    printf("  --seed N         Generator seed (default: 42)\n");
+    printf("  --work-dir DIR   Directory for generated tables and results (default: $TMPDIR or /tmp)\n");
+    printf("  --csv FILE       Write CSV to FILE instead of stdout\n");
+}
+
+int main(int argc, char *argv[]) {
+    static struct option long_options[] = {
+        {"program", required_argument, NULL, 'p'},
+        {"min", required_argument, NULL, 'a'},
+        {"max", required_argument, NULL, 'b'},
+        {"dist", required_argument, NULL, 'd'},
+        {"algo", required_argument, NULL, 'A'},
+        {"zipf", required_argument, NULL, 'z'},
+        {"threads", required_argument, NULL, 't'},
+        {"repeats", required_argument, NULL, 'r'},
+        {"format", required_argument, NULL, 'f'},
+        {"seed", required_argument, NULL, 's'},
+        {"work-dir", required_argument, NULL, 'w'},
+        {"csv", required_argument, NULL, 'c'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    const char *program = "./ema-join-sm-opt";
+    long long min_rows = 1000, max_rows = 1000000000LL;
+    char dists[256] = "uniform,zipf,seqdup,disjoint";
+    char algos[256] = "sm,hash,radix-hash";
+    const char *zipf = "0.5";
+    const char *threads = "1";
+    const char *format = "binary";
+    const char *seed = "42";
+    const char *work_dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    int repeats = 1;
+    FILE *csv = stdout;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "t:r:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'p': program = optarg; break;
+            case 'a': min_rows = atoll(optarg); break;
+            case 'b': max_rows = atoll(optarg); break;
+            case 'd': snprintf(dists, sizeof(dists), "%s", optarg); break;
+            case 'A': snprintf(algos, sizeof(algos), "%s", optarg); break;
+            case 'z': zipf = optarg; break;
+            case 't': threads = optarg; break;
+            case 'r': repeats = atoi(optarg); break;
+            case 'f': format = optarg; break;
+            case 's': seed = optarg; break;
+            case 'w': work_dir = optarg; break;
+            case 'c':
+                csv = fopen(optarg, "w");
+                if (!csv) {
+                    fprintf(stderr, "Error: Cannot create file %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    int binary = strcmp(format, "binary") == 0;
+    if (min_rows <= 0 || max_rows < min_rows || repeats <= 0 || (!binary && strcmp(format, "text") != 0) ||
+        argc - optind > MAX_ARGS - 16) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    char pattern[4096], text1[4096], text2[4096], bin1[4096], bin2[4096], result[4096];
+    snprintf(pattern, sizeof(pattern), "%s/join-bench-%d-%%d.txt", work_dir, (int)getpid());
+    snprintf(text1, sizeof(text1), "%s/join-bench-%d-1.txt", work_dir, (int)getpid());
+    snprintf(text2, sizeof(text2), "%s/join-bench-%d-2.txt", work_dir, (int)getpid());
+    snprintf(bin1, sizeof(bin1), "%s/join-bench-%d-1.bin", work_dir, (int)getpid());
+    snprintf(bin2, sizeof(bin2), "%s/join-bench-%d-2.bin", work_dir, (int)getpid());
+    snprintf(result, sizeof(result), "%s/join-bench-%d-result.txt", work_dir, (int)getpid());
+
+    fprintf(csv, "phase,rows,distribution,algorithm,threads,format,repeat,seconds,rows_per_sec,peak_rss_kb,result_rows\n");
+    fflush(csv);
+
+    long long rows = 1;
+    while (rows < min_rows) {
+        rows *= 10;
+    }
+    for (; rows <= max_rows; rows *= 10) {
+        char size[32];
+        snprintf(size, sizeof(size), "%lld", rows);
+
+        char dist_list[256];
+        snprintf(dist_list, sizeof(dist_list), "%s", dists);
+        char *dist_state;
+        for (char *dist = strtok_r(dist_list, ",", &dist_state); dist; dist = strtok_r(NULL, ",", &dist_state)) {
+            long rss;
+            char *generate[] = {(char *)program, "--generate", size, size, "--dist", dist, "--zipf", (char *)zipf,
+                                "--seed", (char *)seed, "--threads", (char *)threads, "--name", pattern, NULL};
+            double seconds = run(generate, &rss);
+            fprintf(csv, "generate,%lld,%s,,%s,text,0,%.6f,%.0f,%ld,\n", rows, dist, threads, seconds,
+                    2 * rows / seconds, rss);
+
+            const char *input1 = text1, *input2 = text2;
+            if (binary) {
+                char *convert1[] = {(char *)program, "--convert", text1, bin1, NULL};
+                char *convert2[] = {(char *)program, "--convert", text2, bin2, NULL};
+                run(convert1, &rss);
+                run(convert2, &rss);
+                unlink(text1);
+                unlink(text2);
+                input1 = bin1;
+                input2 = bin2;
+            }
+
+            char algo_list[256];
+            snprintf(algo_list, sizeof(algo_list), "%s", algos);
+            char *algo_state;
+            for (char *algo = strtok_r(algo_list, ",", &algo_state); algo; algo = strtok_r(NULL, ",", &algo_state)) {
+                for (int r = 0; r < repeats; r++) {
+                    char *join[MAX_ARGS];
+                    int n = 0;
+                    join[n++] = (char *)program;
+                    join[n++] = "--algo";
+                    join[n++] = algo;
+                    join[n++] = "--threads";
+                    join[n++] = (char *)threads;
+                    join[n++] = "--tmp-dir";
+                    join[n++] = (char *)work_dir;
+                    for (int i = optind; i < argc; i++) {
+                        join[n++] = argv[i];
+                    }
+                    join[n++] = (char *)input1;
+                    join[n++] = (char *)input2;
+                    join[n++] = result;
+                    join[n] = NULL;
+
+                    seconds = run(join, &rss);
+                    fprintf(csv, "join,%lld,%s,%s,%s,%s,%d,%.6f,%.0f,%ld,%lld\n", rows, dist, algo, threads,
+                            format, r, seconds, 2 * rows / seconds, rss, result_rows(result));
+                    fflush(csv);
+                    unlink(result);
+                }
+            }
+            unlink(input1);
+            unlink(input2);
+        }
+        if (rows > max_rows / 10) {
+            break;
+        }
+    }
+
+    if (csv != stdout) {
+        fclose(csv);
+    }
+    return 0;
+}
@@ -0,0 +1,486 @@
+#include "join.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "extsort.h"
+#include "hashjoin.h"
+#include "sort.h"
+#include "util.h"
+#include "workers.h"
+#include "writer.h"
+
+// Единица работы слияния: диапазон ключей или срез блока тяжёлого ключа.
+// base1/base2 - положение входа в отсортированных таблицах (для --compact)
+typedef struct {
+    const Row *rows1;
+    size_t size1;
+    const Row *rows2;
+    size_t size2;
+    size_t base1;
+    size_t base2;
+    unsigned long long weight;   // вход плюс известный заранее результат (срезы тяжёлых ключей)
+    unsigned long long output;   // строк результата, заполняется при слиянии
+} MergeUnit;
+
+typedef struct {
+    MergeUnit *units;
+    size_t count;
+    size_t capacity;
+} MergeUnits;
+
+// Поток сливает подряд идущие единицы [begin, end) в свой выход
+typedef struct {
+    MergeUnit *units;
+    size_t begin;
+    size_t end;
+    RowWriter *writer;
+} MergeTask;
+
+// Ключ, порождающий больше строк, чем вход на поток, режется между потоками на срезы
+typedef struct {
+    int key;
+    size_t begin1, end1;
+    size_t begin2, end2;
+} HeavyKey;
+
+JoinAlgorithm join_algorithm = JOIN_AUTO;
+int join_compact = 0;
+
+static const char *const algorithm_names[] = {"auto", "sm", "hash", "radix-hash"};
+
+#define SAMPLE_SIZE 4096
+#define UNITS_PER_THREAD 4          // диапазонов на поток: запас для выравнивания по весу
+#define HEAVY_SAMPLES_PER_THREAD 64
+#define HASH_SIZE_RATIO 4          // таблицы соизмеримы, если меньшая больше четверти большей
+#define HASH_DISTINCT_RATIO 8      // в среднем больше 8 строк на ключ - тяжёлые дубликаты
+
+// Первая строка с id >= key
+static size_t lower_bound(const Row *rows, size_t size, int key) {
+    size_t low = 0, high = size;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (rows[mid].id < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Первая строка с id > key
+static size_t upper_bound(const Row *rows, size_t size, int key) {
+    size_t low = 0, high = size;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (rows[mid].id <= key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Слияние одной единицы за один проход; возвращает число строк результата
+static unsigned long long merge_unit(const MergeUnit *unit, RowWriter *writer) {
+    const Row *rows1 = unit->rows1;
+    const Row *rows2 = unit->rows2;
+    unsigned long long output = 0;
+    size_t i = 0, j = 0;
+
+    while (i < unit->size1 && j < unit->size2) {
+        if (rows1[i].id < rows2[j].id) {
+            i++;
+        } else if (rows1[i].id > rows2[j].id) {
+            j++;
+        } else {
+            int current_id = rows1[i].id;
+
+            // Находим границы блоков с одинаковым id в обеих таблицах
+            size_t start_i = i;
+            size_t start_j = j;
+
+            while (i < unit->size1 && rows1[i].id == current_id) {
+                i++;
+            }
+            while (j < unit->size2 && rows2[j].id == current_id) {
+                j++;
+            }
+            output += (unsigned long long)(i - start_i) * (j - start_j);
+
+            if (join_compact) {
+                row_writer_put_block(writer, current_id, unit->base1 + start_i, unit->base1 + i,
+                                     unit->base2 + start_j, unit->base2 + j);
+                continue;
+            }
+            // Декартово произведение блоков: каждая строка table1 повторяется count2 раз
+            // и форматируется один раз
+            for (size_t k = start_i; k < i; k++) {
+                row_writer_put_repeat(writer, &rows1[k], j - start_j);
+            }
+        }
+    }
+    return output;
+}
+
+static void *merge_units(void *arg) {
+    MergeTask *task = arg;
+    for (size_t u = task->begin; u < task->end; u++) {
+        task->units[u].output = merge_unit(&task->units[u], task->writer);
+    }
+    return NULL;
+}
+
+static void add_unit(MergeUnits *units, const Table *table1, size_t begin1, size_t end1,
+                     const Table *table2, size_t begin2, size_t end2, unsigned long long known_output) {
+    if (units->count == units->capacity) {
+        units->capacity = units->capacity ? units->capacity * 2 : 64;
+        units->units = checked_realloc(units->units, units->capacity * sizeof(MergeUnit));
+    }
+    MergeUnit *unit = &units->units[units->count++];
+    unit->rows1 = table1->rows + begin1;
+    unit->size1 = end1 - begin1;
+    unit->rows2 = table2->rows + begin2;
+    unit->size2 = end2 - begin2;
+    unit->base1 = begin1;
+    unit->base2 = begin2;
+    unit->weight = (end1 - begin1) + (end2 - begin2) + known_output;
+    unit->output = 0;
+}
+
+void join_output_open(JoinOutput *output, const char *filename, int threads, const char *tmp_dir) {
+    output->count = threads > 1 ? threads : 1;
+    output->writers = checked_malloc(output->count * sizeof(RowWriter));
+    row_writer_open(&output->writers[0], filename);
+    for (int t = 1; t < output->count; t++) {
+        row_writer_open_temp(&output->writers[t], tmp_dir);
+    }
+}
+
+long long join_output_close(JoinOutput *output) {
+    for (int t = 1; t < output->count; t++) {
+        row_writer_append(&output->writers[0], &output->writers[t]);
+    }
+    long long count = output->writers[0].count;
+    row_writer_close(&output->writers[0]);
+    free(output->writers);
+    output->writers = NULL;
+    return count;
+}
+
+// Оценка числа различных id по SAMPLE_SIZE строкам, взятым через равные промежутки.
+// Если выборка насыщена (ключи в ней часто повторяются), ключей почти наверняка столько же,
+// сколько в ней; иначе доля различных в выборке переносится на всю таблицу
+static size_t estimate_distinct(Table table) {
+    int seen[2 * SAMPLE_SIZE];
+    char used[2 * SAMPLE_SIZE] = {0};
+    size_t step = table.size > SAMPLE_SIZE ? (size_t)table.size / SAMPLE_SIZE : 1;
+    size_t sampled = 0, distinct = 0;
+    for (size_t i = 0; i < (size_t)table.size && sampled < SAMPLE_SIZE; i += step, sampled++) {
+        int key = table.rows[i].id;
+        size_t slot = ((uint32_t)key * 0x9E3779B1u) % (2 * SAMPLE_SIZE);
+        while (used[slot] && seen[slot] != key) {
+            slot = (slot + 1) % (2 * SAMPLE_SIZE);
+        }
+        if (!used[slot]) {
+            used[slot] = 1;
+            seen[slot] = key;
+            distinct++;
+        }
+    }
+    if (distinct * 2 <= sampled) {
+        return distinct;
+    }
+    return sampled ? (size_t)table.size * distinct / sampled : 0;
+}
+
+JoinAlgorithm join_choose_algorithm(Table table1, Table table2, int threads) {
+    size_t smaller = table1.size < table2.size ? table1.size : table2.size;
+    size_t larger = table1.size < table2.size ? table2.size : table1.size;
+    size_t keys = estimate_distinct(table1.size <= table2.size ? table1 : table2);
+
+    // На соизмеримых таблицах с разными ключами параллельный sort-merge масштабируется во всех
+    // фазах, а разбиение в radix-hash последовательное. В остальных случаях hash join не сортирует
+    // большую таблицу, и на одном потоке он быстрее даже на равных таблицах
+    if (threads > 1 && smaller * HASH_SIZE_RATIO > larger && keys * HASH_DISTINCT_RATIO > smaller) {
+        return JOIN_SORT_MERGE;
+    }
+    // Разбиение нужно, когда хеш-таблица не помещается в L2. Её размер определяется числом
+    // различных ключей, поэтому при тяжёлых дубликатах она мала при любом числе строк
+    return hash_join_partition_bits(keys) > 0 ? JOIN_RADIX_HASH : JOIN_HASH;
+}
+
+long long join_tables(Table table1, Table table2, JoinAlgorithm algorithm, int threads,
+                      const char *output, const char *tmp_dir) {
+    // Компактный результат ссылается на позиции в отсортированных таблицах
+    if (join_compact && algorithm != JOIN_SORT_MERGE) {
+        if (algorithm != JOIN_AUTO) {
+            fprintf(stderr, "Warning: --compact requires sort-merge, ignoring --algo %s\n",
+                    join_algorithm_name(algorithm));
+        }
+        algorithm = JOIN_SORT_MERGE;
+    }
+    if (algorithm == JOIN_AUTO) {
+        algorithm = join_choose_algorithm(table1, table2, threads);
+        printf("Join algorithm: %s (auto)\n", join_algorithm_name(algorithm));
+    }
+    switch (algorithm) {
+        case JOIN_HASH: return hash_join(table1, table2, 0, threads, output, tmp_dir);
+        case JOIN_RADIX_HASH: return hash_join(table1, table2, 1, threads, output, tmp_dir);
+        default: return sort_merge_join(table1, table2, threads, output, tmp_dir);
+    }
+}
+
+// Промежуток [begin, end) обеих таблиц режется на диапазоны примерно по range_rows строк.
+// Разделители берутся из большей части промежутка, границы в обеих находятся бинарным поиском,
+// поэтому блок одинаковых id целиком попадает в один диапазон
+static void add_ranges(MergeUnits *units, const Table *table1, size_t begin1, size_t end1,
+                       const Table *table2, size_t begin2, size_t end2, size_t range_rows) {
+    size_t rows = (end1 - begin1) + (end2 - begin2);
+    size_t parts = rows / range_rows + 1;
+    int left_larger = end1 - begin1 >= end2 - begin2;
+    const Row *larger = left_larger ? table1->rows + begin1 : table2->rows + begin2;
+    size_t larger_size = left_larger ? end1 - begin1 : end2 - begin2;
+
+    for (size_t p = 0; p < parts; p++) {
+        size_t split1 = end1, split2 = end2;
+        if (p + 1 < parts && larger_size > 0) {
+            int key = larger[larger_size * (p + 1) / parts].id;
+            split1 = begin1 + lower_bound(table1->rows + begin1, end1 - begin1, key);
+            split2 = begin2 + lower_bound(table2->rows + begin2, end2 - begin2, key);
+        }
+        if (split1 > begin1 || split2 > begin2 || p + 1 == parts) {
+            add_unit(units, table1, begin1, split1, table2, begin2, split2, 0);
+        }
+        begin1 = split1;
+        begin2 = split2;
+    }
+}
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Тяжёлые ключи ищутся по выборке из отсортированных таблиц: ключ, занимающий больше 1/S
+// таблицы, обязательно попадёт в выборку с шагом n/S. Точные границы блоков находятся
+// бинарным поиском. Тяжёлым считается ключ, дающий больше строк, чем вход на поток
+static size_t find_heavy_keys(Table table1, Table table2, int threads, HeavyKey **heavy) {
+    size_t samples = (size_t)threads * HEAVY_SAMPLES_PER_THREAD;
+    int *candidates = checked_malloc(2 * samples * sizeof(int));
+    *heavy = checked_malloc(2 * samples * sizeof(HeavyKey));
+    size_t count = 0;
+    const Table *tables[2] = {&table1, &table2};
+    for (int t = 0; t < 2; t++) {
+        for (size_t s = 0; s < samples && tables[t]->size > 0; s++) {
+            candidates[count++] = tables[t]->rows[(size_t)tables[t]->size * s / samples].id;
+        }
+    }
+    qsort(candidates, count, sizeof(int), compare_ints);
+
+    unsigned long long threshold = ((size_t)table1.size + table2.size) / threads;
+    size_t heavy_count = 0;
+    for (size_t c = 0; c < count; c++) {
+        if (c > 0 && candidates[c] == candidates[c - 1]) {
+            continue;
+        }
+        HeavyKey key = {candidates[c], 0, 0, 0, 0};
+        key.begin1 = lower_bound(table1.rows, table1.size, key.key);
+        key.end1 = upper_bound(table1.rows, table1.size, key.key);
+        key.begin2 = lower_bound(table2.rows, table2.size, key.key);
+        key.end2 = upper_bound(table2.rows, table2.size, key.key);
+        unsigned long long output = (unsigned long long)(key.end1 - key.begin1) * (key.end2 - key.begin2);
+        if (output > threshold && output > 1) {
+            (*heavy)[heavy_count++] = key;
+        }
+    }
+    free(candidates);
+    return heavy_count;
+}
+
+// Sort-Merge Join алгоритм
+long long sort_merge_join(Table table1, Table table2, int threads, const char *output,
+                          const char *tmp_dir) {
+    // Шаг 1: Сортируем обе таблицы по id (radix sort или qsort, см. --sort)
+    double sort_start = now();
+    sort_rows(table1.rows, table1.size, threads);
+    sort_rows(table2.rows, table2.size, threads);
+    printf("Sort (%s, %d threads): %.3f seconds\n", sort_algorithm_name(sort_algorithm), threads,
+           now() - sort_start);
+
+    JoinOutput out;
+    join_output_open(&out, output, threads, tmp_dir);
+    threads = out.count;
+
+    HeavyKey *heavy = NULL;
+    size_t heavy_count = threads > 1 && !join_compact ? find_heavy_keys(table1, table2, threads, &heavy) : 0;
+
+    // Единицы в порядке ключей: промежутки между тяжёлыми ключами режутся на диапазоны,
+    // блоки тяжёлых ключей - на срезы по потокам. Все единицы не пересекаются ни по входу,
+    // ни по результату, и результат в порядке единиц совпадает с однопоточным
+    MergeUnits units = {NULL, 0, 0};
+    size_t total = (size_t)table1.size + table2.size;
+    size_t range_rows = total / ((size_t)threads * UNITS_PER_THREAD) + 1;
+    size_t begin1 = 0, begin2 = 0;
+    for (size_t h = 0; h <= heavy_count; h++) {
+        size_t end1 = h < heavy_count ? heavy[h].begin1 : (size_t)table1.size;
+        size_t end2 = h < heavy_count ? heavy[h].begin2 : (size_t)table2.size;
+        add_ranges(&units, &table1, begin1, end1, &table2, begin2, end2, range_rows);
+        if (h == heavy_count) {
+            break;
+        }
+
+        // Режется больший из двух блоков; при срезах table2 строки внутри ключа идут
+        // в другом порядке, но состав результата тот же
+        const HeavyKey *key = &heavy[h];
+        int split_left = key->end1 - key->begin1 >= key->end2 - key->begin2;
+        size_t size = split_left ? key->end1 - key->begin1 : key->end2 - key->begin2;
+        for (int t = 0; t < threads; t++) {
+            size_t slice_begin = size * t / threads;
+            size_t slice_end = size * (t + 1) / threads;
+            size_t other = split_left ? key->end2 - key->begin2 : key->end1 - key->begin1;
+            unsigned long long slice_output = (unsigned long long)(slice_end - slice_begin) * other;
+            if (split_left) {
+                add_unit(&units, &table1, key->begin1 + slice_begin, key->begin1 + slice_end,
+                         &table2, key->begin2, key->end2, slice_output);
+            } else {
+                add_unit(&units, &table1, key->begin1, key->end1,
+                         &table2, key->begin2 + slice_begin, key->begin2 + slice_end, slice_output);
+            }
+        }
+        begin1 = key->end1;
+        begin2 = key->end2;
+    }
+
+    // Потокам достаются подряд идущие единицы примерно равного веса. Вес - вход единицы плюс
+    // результат срезов тяжёлых ключей, уже известный из find_heavy_keys; у обычных диапазонов
+    // результат не больше порога тяжёлого ключа на ключ, и отдельный проход для его подсчёта
+    // стоил бы второго слияния
+    MergeTask *tasks = checked_calloc(threads, sizeof(MergeTask));
+    unsigned long long total_weight = 0, heavy_output = 0;
+    for (size_t u = 0; u < units.count; u++) {
+        total_weight += units.units[u].weight;
+    }
+    for (size_t h = 0; h < heavy_count; h++) {
+        heavy_output += (unsigned long long)(heavy[h].end1 - heavy[h].begin1) * (heavy[h].end2 - heavy[h].begin2);
+    }
+    unsigned long long weight = 0;
+    size_t u = 0;
+    for (int t = 0; t < threads; t++) {
+        tasks[t].units = units.units;
+        tasks[t].begin = u;
+        while (u < units.count && (t == threads - 1 || weight < total_weight * (t + 1) / threads)) {
+            weight += units.units[u].weight;
+            u++;
+        }
+        tasks[t].end = u;
+        tasks[t].writer = &out.writers[t];
+    }
+    run_workers(merge_units, tasks, sizeof(MergeTask), threads);
+
+    unsigned long long result_size = 0;
+    for (size_t v = 0; v < units.count; v++) {
+        result_size += units.units[v].output;
+    }
+    if (heavy_count > 0) {
+        printf("Skew: %zu heavy keys produce %llu of %llu result rows, split across %d threads\n",
+               heavy_count, heavy_output, result_size, threads);
+    }
+
+    long long lines = join_output_close(&out);
+    if (join_compact) {
+        printf("Compact output: %lld blocks\n", lines);
+    }
+    free(tasks);
+    free(units.units);
+    free(heavy);
+    return (long long)result_size;
+}
+
+const char *join_algorithm_name(JoinAlgorithm algorithm) {
+    return algorithm_names[algorithm];
+}
+
+int join_algorithm_from_name(const char *name, JoinAlgorithm *algorithm) {
+    for (size_t i = 0; i < sizeof(algorithm_names) / sizeof(algorithm_names[0]); i++) {
+        if (strcmp(name, algorithm_names[i]) == 0) {
+            *algorithm = (JoinAlgorithm)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Sort-Merge Join во внешней памяти: обе таблицы сортируются в runs на диске и сливаются
+// прямо из потоков слияния. Результат пишется потоком, поэтому память ограничена mem_limit
+// независимо от размера таблиц и результата
+long long external_sort_merge_join(const char *file1, const char *file2, const char *output,
+                                   size_t mem_limit, const char *tmp_dir) {
+    // Фаза 1 для обеих таблиц выполняется до открытия потоков, чтобы каждой досталась вся память;
+    // на финальное слияние каждая таблица получает половину
+    SortedRuns runs1, runs2;
+    external_sort(file1, mem_limit, mem_limit / 2, tmp_dir, &runs1);
+    external_sort(file2, mem_limit, mem_limit / 2, tmp_dir, &runs2);
+
+    MergeStream stream1, stream2;
+    merge_stream_open(&stream1, &runs1, mem_limit / 2);
+    merge_stream_open(&stream2, &runs2, mem_limit / 2);
+
+    RowWriter writer;
+    row_writer_open(&writer, output);
+
+    // Позиции текущих строк в отсортированных таблицах - для блоков --compact
+    size_t pos1 = 0, pos2 = 0;
+    long long result_size = 0;
+    const Row *row1 = merge_stream_peek(&stream1);
+    const Row *row2 = merge_stream_peek(&stream2);
+    while (row1 && row2) {
+        if (row1->id < row2->id) {
+            merge_stream_next(&stream1);
+            row1 = merge_stream_peek(&stream1);
+            pos1++;
+        } else if (row1->id > row2->id) {
+            merge_stream_next(&stream2);
+            row2 = merge_stream_peek(&stream2);
+            pos2++;
+        } else {
+            int current_id = row1->id;
+            size_t start1 = pos1, start2 = pos2;
+
+            // Строка результата берётся из table1, поэтому блок table2 достаточно посчитать
+            long long count2 = 0;
+            while (row2 && row2->id == current_id) {
+                count2++;
+                merge_stream_next(&stream2);
+                row2 = merge_stream_peek(&stream2);
+                pos2++;
+            }
+
+            while (row1 && row1->id == current_id) {
+                if (!join_compact) {
+                    row_writer_put_repeat(&writer, row1, count2);
+                }
+                merge_stream_next(&stream1);
+                row1 = merge_stream_peek(&stream1);
+                pos1++;
+            }
+            if (join_compact) {
+                row_writer_put_block(&writer, current_id, start1, pos1, start2, pos2);
+            }
+            result_size += (long long)(pos1 - start1) * count2;
+        }
+    }
+
+    long long lines = writer.count;
+    row_writer_close(&writer);
+    if (join_compact) {
+        printf("Compact output: %lld blocks\n", lines);
+    }
+    merge_stream_close(&stream1);
+    merge_stream_close(&stream2);
+    return result_size;
+}
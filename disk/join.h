@@ -0,0 +1,53 @@
+#ifndef JOIN_H
+#define JOIN_H
+
+#include <stddef.h>
+
+#include "table.h"
+#include "writer.h"
+
+// Алгоритм соединения таблиц в памяти (--algo)
+typedef enum {
+    JOIN_AUTO,         // выбор по размерам таблиц и числу различных ключей
+    JOIN_SORT_MERGE,
+    JOIN_HASH,
+    JOIN_RADIX_HASH,   // hash join с разбиением на разделы размером с L2
+} JoinAlgorithm;
+
+extern JoinAlgorithm join_algorithm;
+// Компактный результат sort-merge (--compact): строка на блок ключа вместо развёрнутых пар
+extern int join_compact;
+
+// Выход потоков соединения: поток 0 пишет прямо в файл результата, остальные - в свои
+// временные файлы, которые при закрытии дописываются в результат по порядку. Память
+// занимают только буферы потоков, сколько бы строк ни было в результате
+typedef struct {
+    RowWriter *writers;
+    int count;
+} JoinOutput;
+
+void join_output_open(JoinOutput *output, const char *filename, int threads, const char *tmp_dir);
+// Склеивает части и закрывает результат; возвращает число строк
+long long join_output_close(JoinOutput *output);
+
+// Соединяет таблицы алгоритмом algorithm (JOIN_AUTO выбирает его по входным данным) и пишет
+// результат в output потоком; возвращает число строк результата
+long long join_tables(Table table1, Table table2, JoinAlgorithm algorithm, int threads,
+                      const char *output, const char *tmp_dir);
+JoinAlgorithm join_choose_algorithm(Table table1, Table table2, int threads);
+
+// Sort-Merge Join в памяти. При threads > 1 таблицы сортируются параллельно, а слияние
+// делится на непересекающиеся диапазоны id; блоки тяжёлых ключей режутся между потоками.
+// Возвращает число строк результата (при join_compact - развёрнутого)
+long long sort_merge_join(Table table1, Table table2, int threads, const char *output,
+                          const char *tmp_dir);
+
+// Sort-Merge Join во внешней памяти, результат пишется в output (с --compact - блоками по
+// позициям в отсортированных таблицах, как у sort_merge_join); возвращает число строк результата
+long long external_sort_merge_join(const char *file1, const char *file2, const char *output,
+                                   size_t mem_limit, const char *tmp_dir);
+
+const char *join_algorithm_name(JoinAlgorithm algorithm);
+int join_algorithm_from_name(const char *name, JoinAlgorithm *algorithm);
+
+#endif
@@ -0,0 +1,85 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "table.h"
+#include "textparse.h"
+#include "util.h"
+
+// Сравнение разборщиков текстовых таблиц: прежний fscanf против скалярного, SSE4.2 и AVX2.
+// Для каждого файла печатает лучшее из repeats время, MB/s и ускорение относительно stdio,
+// а также проверяет, что все разборщики дают одинаковые строки.
+// Usage: parse-bench [-r repeats] <table_file>...
+
+static uint64_t checksum(Table table) {
+    uint64_t sum = 0;
+    for (long long i = 0; i < table.size; i++) {
+        uint64_t h = (uint32_t)table.rows[i].id;
+        for (const char *c = table.rows[i].word; *c; c++) {
+            h = h * 31 + (unsigned char)*c;
+        }
+        sum = sum * 1099511628211ULL + h;
+    }
+    return sum;
+}
+
+int main(int argc, char *argv[]) {
+    int repeats = 3;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-r") == 0) {
+        repeats = atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || repeats <= 0) {
+        printf("Usage: %s [-r repeats] <table_file>...\n", argv[0]);
+        return 1;
+    }
+
+    const TextParserKind kinds[] = {PARSER_STDIO, PARSER_SCALAR, PARSER_SSE42, PARSER_AVX2};
+    printf("%-28s %-7s %12s %10s %10s %8s\n", "file", "parser", "rows", "seconds", "MB/s", "speedup");
+    for (int f = first; f < argc; f++) {
+        struct stat st;
+        if (stat(argv[f], &st) != 0) {
+            fprintf(stderr, "Error: Cannot open file %s\n", argv[f]);
+            return 1;
+        }
+
+        double baseline = 0;
+        uint64_t expected = 0;
+        for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+            // Неподдерживаемые процессором варианты пропускаются
+            if (!text_parser_supported(kinds[k])) {
+                continue;
+            }
+            text_parser_kind = kinds[k];
+
+            double best = 0;
+            Table table = {0, NULL};
+            for (int r = 0; r < repeats; r++) {
+                free_table(table);
+                double start = now();
+                table = read_table(argv[f]);
+                double elapsed = now() - start;
+                if (r == 0 || elapsed < best) {
+                    best = elapsed;
+                }
+            }
+
+            uint64_t sum = checksum(table);
+            if (k == 0) {
+                baseline = best;
+                expected = sum;
+            } else if (sum != expected) {
+                fprintf(stderr, "Error: %s parser result differs from stdio on %s\n",
+                        text_parser_name(kinds[k]), argv[f]);
+                return 1;
+            }
+            printf("%-28s %-7s %12lld %10.4f %10.1f %7.2fx\n", argv[f], text_parser_name(kinds[k]), table.size,
+                   best, st.st_size / best / 1e6, baseline / best);
+            free_table(table);
+        }
+    }
+    return 0;
+}
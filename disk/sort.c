@@ -0,0 +1,211 @@
+#include "sort.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "workers.h"
+
+// Ключ делится на три цифры по 11, 11 и 10 бит: гистограммы (3 x 2048 счётчиков)
+// помещаются в L1, а проходов по данным на один меньше, чем с байтовыми цифрами
+#define RADIX_BITS 11
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES 3
+#define INSERTION_THRESHOLD 64
+
+SortAlgorithm sort_algorithm = SORT_RADIX;
+
+static const char *const algorithm_names[] = {"radix", "qsort"};
+
+int compare_rows(const void *a, const void *b) {
+    const Row *row_a = (const Row *)a;
+    const Row *row_b = (const Row *)b;
+    return (row_a->id > row_b->id) - (row_a->id < row_b->id);
+}
+
+// Инверсия знакового бита: отрицательные id идут раньше положительных при беззнаковом сравнении
+static inline uint32_t radix_key(const Row *row) {
+    return (uint32_t)row->id ^ 0x80000000u;
+}
+
+static void insertion_sort_rows(Row *rows, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        Row row = rows[i];
+        size_t j = i;
+        while (j > 0 && rows[j - 1].id > row.id) {
+            rows[j] = rows[j - 1];
+            j--;
+        }
+        rows[j] = row;
+    }
+}
+
+void radix_sort_rows(Row *rows, size_t count, Row *scratch) {
+    if (count < INSERTION_THRESHOLD) {
+        insertion_sort_rows(rows, count);
+        return;
+    }
+
+    int own_scratch = scratch == NULL;
+    if (own_scratch) {
+        scratch = malloc(count * sizeof(Row));
+        if (!scratch) {
+            fprintf(stderr, "Warning: Not enough memory for radix sort, falling back to qsort\n");
+            qsort(rows, count, sizeof(Row), compare_rows);
+            return;
+        }
+    }
+
+    // Все гистограммы считаются за один проход по данным
+    size_t histogram[RADIX_PASSES][RADIX_BUCKETS];
+    memset(histogram, 0, sizeof(histogram));
+    for (size_t i = 0; i < count; i++) {
+        uint32_t key = radix_key(&rows[i]);
+        histogram[0][key & (RADIX_BUCKETS - 1)]++;
+        histogram[1][(key >> RADIX_BITS) & (RADIX_BUCKETS - 1)]++;
+        histogram[2][key >> (2 * RADIX_BITS)]++;
+    }
+
+    Row *src = rows;
+    Row *dst = scratch;
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+        size_t *counts = histogram[pass];
+        int shift = pass * RADIX_BITS;
+
+        // Если цифра у всех ключей одинакова, проход ничего не меняет (типично для узкого диапазона id)
+        uint32_t digit = (radix_key(&src[0]) >> shift) & (RADIX_BUCKETS - 1);
+        if (counts[digit] == count) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (int b = 0; b < RADIX_BUCKETS; b++) {
+            size_t c = counts[b];
+            counts[b] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < count; i++) {
+            uint32_t d = (radix_key(&src[i]) >> shift) & (RADIX_BUCKETS - 1);
+            dst[counts[d]++] = src[i];
+        }
+
+        Row *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != rows) {
+        memcpy(rows, src, count * sizeof(Row));
+    }
+    if (own_scratch) {
+        free(scratch);
+    }
+}
+
+// Часть массива, которую обрабатывает один поток на проходе параллельной сортировки
+typedef struct {
+    const Row *src;
+    Row *dst;
+    size_t begin;
+    size_t end;
+    int shift;
+    size_t counts[RADIX_BUCKETS];  // гистограмма части, затем - позиции записи в dst
+} RadixTask;
+
+static void *radix_count(void *arg) {
+    RadixTask *task = arg;
+    memset(task->counts, 0, sizeof(task->counts));
+    for (size_t i = task->begin; i < task->end; i++) {
+        task->counts[(radix_key(&task->src[i]) >> task->shift) & (RADIX_BUCKETS - 1)]++;
+    }
+    return NULL;
+}
+
+static void *radix_scatter(void *arg) {
+    RadixTask *task = arg;
+    for (size_t i = task->begin; i < task->end; i++) {
+        uint32_t d = (radix_key(&task->src[i]) >> task->shift) & (RADIX_BUCKETS - 1);
+        task->dst[task->counts[d]++] = task->src[i];
+    }
+    return NULL;
+}
+
+// Каждый проход: потоки считают гистограммы своих частей, затем раскладывают строки
+// по смещениям, которые не пересекаются между потоками, поэтому запись идёт без блокировок
+static void parallel_radix_sort_rows(Row *rows, size_t count, int threads) {
+    Row *scratch = malloc(count * sizeof(Row));
+    RadixTask *tasks = malloc(threads * sizeof(RadixTask));
+    if (!scratch || !tasks) {
+        free(scratch);
+        free(tasks);
+        radix_sort_rows(rows, count, NULL);
+        return;
+    }
+
+    Row *src = rows;
+    Row *dst = scratch;
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+        for (int t = 0; t < threads; t++) {
+            tasks[t].src = src;
+            tasks[t].dst = dst;
+            tasks[t].begin = count * t / threads;
+            tasks[t].end = count * (t + 1) / threads;
+            tasks[t].shift = pass * RADIX_BITS;
+        }
+        run_workers(radix_count, tasks, sizeof(RadixTask), threads);
+
+        // Смещения идут по корзинам, а внутри корзины - по потокам в порядке частей,
+        // так что сортировка остаётся стабильной
+        size_t offset = 0;
+        int single_bucket = 0;
+        for (int b = 0; b < RADIX_BUCKETS; b++) {
+            size_t bucket = 0;
+            for (int t = 0; t < threads; t++) {
+                size_t c = tasks[t].counts[b];
+                tasks[t].counts[b] = offset;
+                offset += c;
+                bucket += c;
+            }
+            single_bucket |= bucket == count;
+        }
+        if (single_bucket) {
+            continue;
+        }
+        run_workers(radix_scatter, tasks, sizeof(RadixTask), threads);
+
+        Row *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != rows) {
+        memcpy(rows, src, count * sizeof(Row));
+    }
+    free(tasks);
+    free(scratch);
+}
+
+void sort_rows(Row *rows, size_t count, int threads) {
+    if (sort_algorithm == SORT_QSORT) {
+        qsort(rows, count, sizeof(Row), compare_rows);
+    } else if (threads > 1 && count >= (size_t)threads * RADIX_BUCKETS) {
+        parallel_radix_sort_rows(rows, count, threads);
+    } else {
+        radix_sort_rows(rows, count, NULL);
+    }
+}
+
+const char *sort_algorithm_name(SortAlgorithm algorithm) {
+    return algorithm_names[algorithm];
+}
+
+int sort_algorithm_from_name(const char *name, SortAlgorithm *algorithm) {
+    for (size_t i = 0; i < sizeof(algorithm_names) / sizeof(algorithm_names[0]); i++) {
+        if (strcmp(name, algorithm_names[i]) == 0) {
+            *algorithm = (SortAlgorithm)i;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <stddef.h>
+
+#include "table.h"
+
+// Сортировка строк по id. По умолчанию - LSD radix sort: стабильная, без косвенных вызовов
+// сравнения, O(n) на проход. qsort оставлен для сравнения (--sort qsort)
+
+typedef enum {
+    SORT_RADIX,
+    SORT_QSORT,
+} SortAlgorithm;
+
+extern SortAlgorithm sort_algorithm;
+
+// Функция сравнения для qsort; без вычитания, поэтому не переполняется на больших id
+int compare_rows(const void *a, const void *b);
+
+// Сортирует выбранным алгоритмом (sort_algorithm); radix sort при threads > 1 - параллельный
+void sort_rows(Row *rows, size_t count, int threads);
+// scratch - буфер на count строк; NULL - выделить временно
+void radix_sort_rows(Row *rows, size_t count, Row *scratch);
+
+const char *sort_algorithm_name(SortAlgorithm algorithm);
+int sort_algorithm_from_name(const char *name, SortAlgorithm *algorithm);
+
+#endif
@@ -0,0 +1,183 @@
+#include "table.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "util.h"
+#include "writer.h"
+
+#define SPOOL_BUFFER (1 << 20)
+#define MAX_SPOOLED 2  // обе входные таблицы
+
+static char spooled[MAX_SPOOLED][4096];
+static int spooled_count = 0;
+
+static void remove_spooled(void) {
+    for (int i = 0; i < spooled_count; i++) {
+        unlink(spooled[i]);
+    }
+}
+
+const char *table_spool(const char *filename, const char *tmp_dir) {
+    struct stat st;
+    if (stat(filename, &st) == 0 && S_ISREG(st.st_mode)) {
+        return filename;
+    }
+    if (spooled_count == MAX_SPOOLED) {
+        fprintf(stderr, "Error: Too many non-regular inputs\n");
+        exit(1);
+    }
+    int in = open(filename, O_RDONLY);
+    if (in == -1) {
+        fprintf(stderr, "Error: Cannot open file %s\n", filename);
+        exit(1);
+    }
+    char *path = spooled[spooled_count];
+    int out = create_named_temp_file(tmp_dir, path, sizeof(spooled[0]));
+    if (spooled_count++ == 0) {
+        atexit(remove_spooled);
+    }
+
+    char *buffer = checked_malloc(SPOOL_BUFFER);
+    while (1) {
+        ssize_t n = read(in, buffer, SPOOL_BUFFER);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n == -1) {
+            fprintf(stderr, "Error: Cannot read %s: %s\n", filename, strerror(errno));
+            exit(1);
+        }
+        if (n == 0) {
+            break;
+        }
+        write_all(out, buffer, n, "temporary file");
+    }
+    free(buffer);
+    close(in);
+    close(out);
+    return path;
+}
+
+void table_reader_open(TableReader *reader, const char *filename) {
+    reader->filename = filename;
+    reader->read = 0;
+    reader->binary.map = NULL;
+    reader->text.data = NULL;
+    if (is_binary_table(filename)) {
+        binary_table_open(&reader->binary, filename);
+        if (reader->binary.rows > LLONG_MAX) {
+            fprintf(stderr, "Error: Too many rows in %s\n", filename);
+            exit(1);
+        }
+        reader->file = NULL;
+        reader->size = (long long)reader->binary.rows;
+        return;
+    }
+
+    TextParserKind kind = text_parser_resolve(text_parser_kind);
+    if (kind != PARSER_STDIO) {
+        text_parser_open(&reader->text, filename, kind, &reader->size);
+        reader->file = NULL;
+        return;
+    }
+
+    reader->file = fopen(filename, "r");
+    if (!reader->file) {
+        fprintf(stderr, "Error: Cannot open file %s\n", filename);
+        exit(1);
+    }
+    if (fscanf(reader->file, "%lld", &reader->size) != 1 || reader->size < 0) {
+        fprintf(stderr, "Error: Cannot read table size from %s\n", filename);
+        fclose(reader->file);
+        exit(1);
+    }
+}
+
+// Колонки из mmap переставляются в строки: только копирование, без разбора текста
+static size_t binary_reader_next(TableReader *reader, Row *rows, size_t max_rows) {
+    size_t count = (size_t)(reader->size - reader->read);
+    if (count > max_rows) {
+        count = max_rows;
+    }
+    const int32_t *ids = reader->binary.ids + reader->read;
+    const char *words = reader->binary.words + (size_t)reader->read * BINTABLE_WORD;
+    for (size_t i = 0; i < count; i++) {
+        rows[i].id = ids[i];
+        memcpy(rows[i].word, words + i * BINTABLE_WORD, BINTABLE_WORD);
+        rows[i].word[BINTABLE_WORD] = '\0';
+    }
+    reader->read += count;
+    return count;
+}
+
+size_t table_reader_next(TableReader *reader, Row *rows, size_t max_rows) {
+    if (reader->binary.map) {
+        return binary_reader_next(reader, rows, max_rows);
+    }
+    if (reader->text.data) {
+        size_t count = (size_t)(reader->size - reader->read);
+        if (count > max_rows) {
+            count = max_rows;
+        }
+        text_parser_next(&reader->text, rows, count, reader->read, reader->filename);
+        reader->read += count;
+        return count;
+    }
+    size_t count = 0;
+    while (count < max_rows && reader->read < reader->size) {
+        if (fscanf(reader->file, "%d %8s", &rows[count].id, rows[count].word) != 2) {
+            fprintf(stderr, "Error: Cannot read row %lld from %s\n", reader->read, reader->filename);
+            fclose(reader->file);
+            exit(1);
+        }
+        count++;
+        reader->read++;
+    }
+    return count;
+}
+
+void table_reader_close(TableReader *reader) {
+    if (reader->binary.map) {
+        binary_table_close(&reader->binary);
+    } else if (reader->text.data) {
+        text_parser_close(&reader->text);
+    } else {
+        fclose(reader->file);
+    }
+    reader->file = NULL;
+}
+
+// Чтение таблицы из файла
+Table read_table(const char *filename) {
+    TableReader reader;
+    table_reader_open(&reader, filename);
+
+    Table table;
+    table.size = reader.size;
+    table.rows = checked_malloc((size_t)table.size * sizeof(Row));
+
+    table_reader_next(&reader, table.rows, table.size);
+    table_reader_close(&reader);
+    return table;
+}
+
+// Запись таблицы в файл
+void write_table(const char *filename, Table table) {
+    RowWriter writer;
+    row_writer_open(&writer, filename);
+    for (long long i = 0; i < table.size; i++) {
+        row_writer_put(&writer, &table.rows[i]);
+    }
+    row_writer_close(&writer);
+}
+
+// Освобождение памяти таблицы
+void free_table(Table table) {
+    free(table.rows);
+}
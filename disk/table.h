@@ -0,0 +1,50 @@
+#ifndef TABLE_H
+#define TABLE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "bintable.h"
+#include "textparse.h"
+
+#define WORD_SIZE 9  // 8 символов + 1 для '\0'
+
+typedef struct Row {
+    int id;
+    char word[WORD_SIZE];
+} Row;
+
+typedef struct {
+    long long size;   // 64 бита: число строк входной таблицы может превышать INT_MAX
+    Row *rows;
+} Table;
+
+// Потоковое чтение таблицы порциями, без загрузки целиком в память.
+// Формат определяется по сигнатуре: бинарная таблица читается из mmap без разбора
+typedef struct {
+    FILE *file;           // текстовый формат через stdio (--parser stdio)
+    TextParser text;      // текстовый формат, если text.data != NULL
+    BinaryTable binary;   // бинарный формат, если binary.map != NULL
+    const char *filename;
+    long long size;   // число строк из заголовка файла
+    long long read;   // сколько строк уже прочитано
+} TableReader;
+
+// Вход не из обычного файла (пайп, <(zcat big.gz)) копируется потоком во временный файл в
+// tmp_dir: его можно открыть повторно и отобразить в память. Возвращает путь копии (удаляется
+// при выходе) или сам filename
+const char *table_spool(const char *filename, const char *tmp_dir);
+
+void table_reader_open(TableReader *reader, const char *filename);
+// Читает до max_rows строк, возвращает число прочитанных (0 - таблица закончилась)
+size_t table_reader_next(TableReader *reader, Row *rows, size_t max_rows);
+void table_reader_close(TableReader *reader);
+
+// Чтение таблицы из файла целиком
+Table read_table(const char *filename);
+// Запись таблицы в файл
+void write_table(const char *filename, Table table);
+// Освобождение памяти таблицы
+void free_table(Table table);
+
+#endif
@@ -0,0 +1,283 @@
+#include "textparse.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <immintrin.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "table.h"
+
+#define BLOCK 64
+
+TextParserKind text_parser_kind = PARSER_AUTO;
+
+static const char *const parser_names[] = {"auto", "stdio", "scalar", "sse42", "avx2"};
+
+// Разделители те же, что fscanf пропускает между полями (isspace в локали "C")
+static int is_space(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static uint64_t classify_scalar(const char *block) {
+    uint64_t mask = 0;
+    for (int i = 0; i < BLOCK; i++) {
+        mask |= (uint64_t)is_space(block[i]) << i;
+    }
+    return mask;
+}
+
+// pcmpestrm сравнивает 16 байт сразу со всем набором разделителей
+__attribute__((target("sse4.2")))
+static uint64_t classify_sse42(const char *block) {
+    const __m128i spaces = _mm_setr_epi8(' ', '\t', '\n', '\v', '\f', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    uint64_t mask = 0;
+    for (int i = 0; i < BLOCK / 16; i++) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(block + 16 * i));
+        __m128i match = _mm_cmpestrm(spaces, 6, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK);
+        mask |= (uint64_t)(uint16_t)_mm_cvtsi128_si32(match) << (16 * i);
+    }
+    return mask;
+}
+
+// ' ' или '\t'..'\r': беззнаковое c - '\t' <= 4 проверяется через min
+__attribute__((target("avx2")))
+static uint64_t classify_avx2(const char *block) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i four = _mm256_set1_epi8(4);
+    uint64_t mask = 0;
+    for (int i = 0; i < BLOCK / 32; i++) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(block + 32 * i));
+        __m256i shifted = _mm256_sub_epi8(chunk, tab);
+        __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, four), shifted);
+        __m256i spaces = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), control);
+        mask |= (uint64_t)(uint32_t)_mm256_movemask_epi8(spaces) << (32 * i);
+    }
+    return mask;
+}
+
+int text_parser_supported(TextParserKind kind) {
+    __builtin_cpu_init();
+    switch (kind) {
+        case PARSER_AVX2: return __builtin_cpu_supports("avx2");
+        case PARSER_SSE42: return __builtin_cpu_supports("sse4.2");
+        default: return 1;
+    }
+}
+
+TextParserKind text_parser_resolve(TextParserKind kind) {
+    if (!text_parser_supported(kind)) {
+        fprintf(stderr, "Warning: %s parser is not supported by this CPU, using the best available\n",
+                parser_names[kind]);
+        kind = PARSER_AUTO;
+    }
+    if (kind == PARSER_AUTO) {
+        kind = text_parser_supported(PARSER_AVX2)    ? PARSER_AVX2
+               : text_parser_supported(PARSER_SSE42) ? PARSER_SSE42
+                                                     : PARSER_SCALAR;
+    }
+    return kind;
+}
+
+const char *text_parser_name(TextParserKind kind) {
+    return parser_names[kind];
+}
+
+int text_parser_from_name(const char *name, TextParserKind *kind) {
+    for (size_t i = 0; i < sizeof(parser_names) / sizeof(parser_names[0]); i++) {
+        if (strcmp(name, parser_names[i]) == 0) {
+            *kind = (TextParserKind)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Классифицирует следующий блок. Байты за концом файла считаются разделителями, поэтому
+// последний токен всегда закрыт; блок, начинающийся ровно на конце файла, обрабатывается тоже
+static int load_block(TextParser *parser) {
+    if (parser->next_block > parser->length) {
+        return 0;
+    }
+    const char *block = parser->data + parser->next_block;
+    char tail[BLOCK];
+    if (parser->length - parser->next_block < BLOCK) {
+        size_t left = parser->length - parser->next_block;
+        memcpy(tail, block, left);
+        memset(tail + left, '\n', BLOCK - left);
+        block = tail;
+    }
+
+    uint64_t spaces = parser->classify(block);
+    uint64_t after_space = (spaces << 1) | parser->carry;
+    parser->carry = spaces >> 63;
+    parser->starts = ~spaces & after_space;
+    parser->ends = spaces & ~after_space;
+    parser->block = parser->next_block;
+    parser->next_block += BLOCK;
+    return 1;
+}
+
+static int next_token(TextParser *parser, const char **token, size_t *length) {
+    while (1) {
+        uint64_t bits = parser->starts | parser->ends;
+        if (bits == 0) {
+            if (!load_block(parser)) {
+                return 0;
+            }
+            continue;
+        }
+        uint64_t bit = bits & -bits;
+        size_t pos = parser->block + __builtin_ctzll(bits);
+        if (parser->starts & bit) {
+            parser->starts ^= bit;
+            parser->token_start = pos;
+        } else {
+            parser->ends ^= bit;
+            *token = parser->data + parser->token_start;
+            *length = pos - parser->token_start;
+            return 1;
+        }
+    }
+}
+
+// Восемь ASCII-цифр (старшая - в младшем байте) в число за три умножения
+static uint32_t swar_digits(uint64_t v) {
+    v = (v & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+    v = (v & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+    return (uint32_t)((v & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+}
+
+static int swar_all_digits(uint64_t v) {
+    return ((v & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+static int parse_int(const TextParser *parser, const char *s, size_t length, int *out) {
+    int negative = *s == '-';
+    if (negative || *s == '+') {
+        s++;
+        length--;
+    }
+    if (length == 0 || length > 10) {
+        return 0;
+    }
+
+    uint64_t value = 0;
+    if (length <= 8 && s + 8 <= parser->data + parser->length) {
+        // Цифры сдвигаются к старшим байтам, освободившиеся младшие заполняются '0'
+        uint64_t v;
+        memcpy(&v, s, 8);
+        int shift = 8 * (8 - (int)length);
+        v = shift ? (v << shift) | (0x3030303030303030ULL >> (64 - shift)) : v;
+        if (!swar_all_digits(v)) {
+            return 0;
+        }
+        value = swar_digits(v);
+    } else {
+        for (size_t i = 0; i < length; i++) {
+            unsigned digit = (unsigned char)s[i] - '0';
+            if (digit > 9) {
+                return 0;
+            }
+            value = value * 10 + digit;
+        }
+    }
+
+    if (value > (uint64_t)INT_MAX + negative) {
+        return 0;
+    }
+    *out = negative ? (int)(-(int64_t)value) : (int)value;
+    return 1;
+}
+
+// Заголовок - число строк: без знака, до 18 цифр, чтобы не переполнить long long
+static int parse_count(const char *s, size_t length, long long *out) {
+    if (length == 0 || length > 18) {
+        return 0;
+    }
+    long long value = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned digit = (unsigned char)s[i] - '0';
+        if (digit > 9) {
+            return 0;
+        }
+        value = value * 10 + digit;
+    }
+    *out = value;
+    return 1;
+}
+
+void text_parser_open(TextParser *parser, const char *filename, TextParserKind kind, long long *size) {
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "Error: Cannot open file %s\n", filename);
+        exit(1);
+    }
+    // Пайп не читается в память целиком: такой вход копирует во временный файл table_spool
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        fprintf(stderr, "Error: %s is not a regular file\n", filename);
+        exit(1);
+    }
+    if (st.st_size == 0) {
+        fprintf(stderr, "Error: Cannot read table size from %s\n", filename);
+        exit(1);
+    }
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map %s: %s\n", filename, strerror(errno));
+        exit(1);
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    parser->data = map;
+    parser->length = st.st_size;
+    close(fd);
+
+    switch (text_parser_resolve(kind)) {
+        case PARSER_AVX2: parser->classify = classify_avx2; break;
+        case PARSER_SSE42: parser->classify = classify_sse42; break;
+        default: parser->classify = classify_scalar; break;
+    }
+    parser->block = 0;
+    parser->next_block = 0;
+    parser->starts = 0;
+    parser->ends = 0;
+    parser->carry = 1;  // начало файла - как после разделителя
+
+    const char *token;
+    size_t length;
+    if (!next_token(parser, &token, &length) || !parse_count(token, length, size)) {
+        fprintf(stderr, "Error: Cannot read table size from %s\n", filename);
+        exit(1);
+    }
+}
+
+size_t text_parser_next(TextParser *parser, Row *rows, size_t max_rows, long long row_index,
+                        const char *filename) {
+    const char *data_end = parser->data + parser->length;
+    for (size_t i = 0; i < max_rows; i++) {
+        const char *token;
+        size_t length;
+        if (!next_token(parser, &token, &length) || !parse_int(parser, token, length, &rows[i].id) ||
+            !next_token(parser, &token, &length) || length >= WORD_SIZE) {
+            fprintf(stderr, "Error: Cannot read row %lld from %s\n", row_index + (long long)i, filename);
+            exit(1);
+        }
+        // Слово копируется фиксированными 8 байтами, хвост за '\0' не используется
+        memcpy(rows[i].word, token, token + 8 <= data_end ? 8 : length);
+        rows[i].word[length] = '\0';
+    }
+    return max_rows;
+}
+
+void text_parser_close(TextParser *parser) {
+    munmap((void *)parser->data, parser->length);
+    parser->data = NULL;
+}
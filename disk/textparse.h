@@ -0,0 +1,50 @@
+#ifndef TEXTPARSE_H
+#define TEXTPARSE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct Row;
+
+// Разбор текстового формата таблицы без stdio. Файл (только обычный) отображается через mmap
+// и обрабатывается блоками по 64 байта: векторная классификация даёт 64-битную маску
+// разделителей, по которой границы токенов находятся через ctz. id разбирается SWAR-преобразованием восьми цифр за раз.
+
+typedef enum {
+    PARSER_AUTO,    // лучший из поддерживаемых процессором
+    PARSER_STDIO,   // прежний fscanf("%d %8s"), для сравнения
+    PARSER_SCALAR,
+    PARSER_SSE42,
+    PARSER_AVX2,
+} TextParserKind;
+
+typedef struct {
+    const char *data;
+    size_t length;
+    uint64_t (*classify)(const char *block);
+    size_t block;            // смещение текущего блока
+    size_t next_block;
+    uint64_t starts;         // ещё не обработанные начала и концы токенов в текущем блоке
+    uint64_t ends;
+    uint64_t carry;          // был ли разделителем последний байт предыдущего блока
+    size_t token_start;
+} TextParser;
+
+// Реализация, выбранная для текстовых таблиц (--parser)
+extern TextParserKind text_parser_kind;
+
+// Поддерживает ли процессор реализацию (проверка cpuid)
+int text_parser_supported(TextParserKind kind);
+// PARSER_AUTO превращается в конкретную реализацию по cpuid
+TextParserKind text_parser_resolve(TextParserKind kind);
+const char *text_parser_name(TextParserKind kind);
+int text_parser_from_name(const char *name, TextParserKind *kind);
+
+// Открывает файл и разбирает заголовок; kind не может быть PARSER_STDIO
+void text_parser_open(TextParser *parser, const char *filename, TextParserKind kind, long long *size);
+// Разбирает до max_rows строк; row_index - номер первой строки для сообщений об ошибках
+size_t text_parser_next(TextParser *parser, struct Row *rows, size_t max_rows, long long row_index,
+                        const char *filename);
+void text_parser_close(TextParser *parser);
+
+#endif
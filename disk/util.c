@@ -0,0 +1,76 @@
+#include "util.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// NULL на запрос нулевого размера - не ошибка
+static void *check_allocation(void *p, int nonempty) {
+    if (!p && nonempty) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    return p;
+}
+
+void *checked_malloc(size_t size) {
+    return check_allocation(malloc(size), size > 0);
+}
+
+void *checked_calloc(size_t count, size_t size) {
+    return check_allocation(calloc(count, size), count > 0 && size > 0);
+}
+
+void *checked_realloc(void *data, size_t size) {
+    return check_allocation(realloc(data, size), size > 0);
+}
+
+void *checked_aligned_alloc(size_t alignment, size_t size) {
+    void *p = NULL;
+    if (posix_memalign(&p, alignment, size) != 0) {
+        p = NULL;
+    }
+    return check_allocation(p, size > 0);
+}
+
+int create_named_temp_file(const char *tmp_dir, char *path, size_t size) {
+    snprintf(path, size, "%s/ema-join-XXXXXX", tmp_dir);
+    int fd = mkstemp(path);
+    if (fd == -1) {
+        fprintf(stderr, "Error: Cannot create temporary file in %s: %s\n", tmp_dir, strerror(errno));
+        exit(1);
+    }
+    return fd;
+}
+
+int create_temp_file(const char *tmp_dir) {
+    char path[4096];
+    int fd = create_named_temp_file(tmp_dir, path, sizeof(path));
+    unlink(path);
+    return fd;
+}
+
+void write_all(int fd, const void *data, size_t bytes, const char *what) {
+    const char *p = data;
+    while (bytes > 0) {
+        ssize_t written = write(fd, p, bytes);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error: Cannot write %s: %s\n", what, strerror(errno));
+            exit(1);
+        }
+        p += written;
+        bytes -= written;
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef UTIL_H
+#define UTIL_H
+
+#include <stddef.h>
+
+// Монотонное время в секундах: clock() при нескольких потоках суммирует их процессорное время
+double now(void);
+
+// Выделение памяти, завершающее программу с "Error: Memory allocation failed" при нехватке
+void *checked_malloc(size_t size);
+void *checked_calloc(size_t count, size_t size);
+void *checked_realloc(void *data, size_t size);
+// Память, выровненная по alignment (степень двойки, кратная sizeof(void *))
+void *checked_aligned_alloc(size_t alignment, size_t size);
+
+// Временный файл ema-join-XXXXXX в tmp_dir; путь пишется в path (size байт)
+int create_named_temp_file(const char *tmp_dir, char *path, size_t size);
+// Безымянный временный файл: удаляется сразу и живёт, пока открыт fd
+int create_temp_file(const char *tmp_dir);
+
+// write() до конца с повтором после EINTR; при ошибке "Error: Cannot write <what>" и выход
+void write_all(int fd, const void *data, size_t bytes, const char *what);
+
+#endif
@@ -0,0 +1,29 @@
+#include "workers.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+
+void run_workers(void *(*fn)(void *), void *args, size_t arg_size, int count) {
+    if (count <= 0) {
+        return;
+    }
+    pthread_t *threads = checked_malloc(count * sizeof(pthread_t));
+
+    char *arg = args;
+    for (int i = 0; i < count - 1; i++) {
+        int err = pthread_create(&threads[i], NULL, fn, arg + i * arg_size);
+        if (err != 0) {
+            fprintf(stderr, "Error: Cannot create thread: %s\n", strerror(err));
+            exit(1);
+        }
+    }
+    fn(arg + (count - 1) * arg_size);
+    for (int i = 0; i < count - 1; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
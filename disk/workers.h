@@ -0,0 +1,10 @@
+#ifndef WORKERS_H
+#define WORKERS_H
+
+#include <stddef.h>
+
+// Запускает fn для каждого из count аргументов (args - массив элементов по arg_size байт)
+// в отдельных потоках; последний выполняется в вызывающем потоке. Возвращает после завершения всех
+void run_workers(void *(*fn)(void *), void *args, size_t arg_size, int count);
+
+#endif
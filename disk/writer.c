@@ -0,0 +1,218 @@
+#include "writer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "util.h"
+
+#define WRITER_BUFFER (1 << 20)
+#define WRITER_ALIGN 4096
+#define HEADER_WIDTH 20  // хватает на любое 64-битное число строк
+#define MAX_ROW_TEXT 32  // "-2147483648 " + 8 байт слова + '\n', с запасом под копирование по 32 байта
+#define MAX_BLOCK_TEXT 96  // id и четыре 64-битные границы
+
+int output_direct = 0;
+
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Десятичная запись без printf: по две цифры за деление, с конца во временный буфер
+static inline char *format_int(char *out, int value) {
+    uint32_t v = (uint32_t)value;
+    if (value < 0) {
+        *out++ = '-';
+        v = 0u - v;
+    }
+    char digits[10];
+    char *p = digits + sizeof(digits);
+    while (v >= 100) {
+        uint32_t pair = v % 100;
+        v /= 100;
+        p -= 2;
+        memcpy(p, digit_pairs + 2 * pair, 2);
+    }
+    if (v >= 10) {
+        p -= 2;
+        memcpy(p, digit_pairs + 2 * v, 2);
+    } else {
+        *--p = (char)('0' + v);
+    }
+    size_t length = digits + sizeof(digits) - p;
+    memcpy(out, p, length);
+    return out + length;
+}
+
+static inline char *format_u64(char *out, uint64_t v) {
+    char digits[20];
+    char *p = digits + sizeof(digits);
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    size_t length = digits + sizeof(digits) - p;
+    memcpy(out, p, length);
+    return out + length;
+}
+
+// "id word\n"; слово копируется фиксированными 8 байтами, указатель сдвигается на его длину
+static inline char *format_row(char *out, const Row *row) {
+    out = format_int(out, row->id);
+    *out++ = ' ';
+    memcpy(out, row->word, 8);
+    out += strnlen(row->word, 8);
+    *out++ = '\n';
+    return out;
+}
+
+// С O_DIRECT сбрасываются только целые блоки, остаток переносится в начало буфера.
+// При final остаток тоже нужно записать, поэтому O_DIRECT снимается
+static void writer_flush(RowWriter *writer, int final) {
+    size_t bytes = writer->used;
+    if (writer->direct && !final) {
+        bytes -= bytes % WRITER_ALIGN;
+    }
+    if (writer->direct && final) {
+        int flags = fcntl(writer->fd, F_GETFL);
+        if (flags == -1 || fcntl(writer->fd, F_SETFL, flags & ~O_DIRECT) == -1) {
+            fprintf(stderr, "Error: Cannot write result: %s\n", strerror(errno));
+            exit(1);
+        }
+        writer->direct = 0;
+    }
+    write_all(writer->fd, writer->buffer, bytes, "result");
+    writer->written += bytes;
+    writer->used -= bytes;
+    memmove(writer->buffer, writer->buffer + bytes, writer->used);
+}
+
+static void writer_init(RowWriter *writer, int fd, int direct) {
+    writer->buffer = checked_aligned_alloc(WRITER_ALIGN, WRITER_BUFFER);
+    writer->fd = fd;
+    writer->used = 0;
+    writer->written = 0;
+    writer->direct = direct;
+    writer->header = 0;
+    writer->count = 0;
+}
+
+void row_writer_open(RowWriter *writer, const char *filename) {
+    int direct = output_direct;
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | (direct ? O_DIRECT : 0), 0644);
+    if (fd == -1 && direct && errno == EINVAL) {
+        // Файловая система (например, tmpfs) не поддерживает O_DIRECT
+        fprintf(stderr, "Warning: O_DIRECT is not supported for %s, using buffered output\n", filename);
+        direct = 0;
+        fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (fd == -1) {
+        fprintf(stderr, "Error: Cannot create file %s\n", filename);
+        exit(1);
+    }
+    writer_init(writer, fd, direct);
+    memset(writer->buffer, ' ', HEADER_WIDTH);
+    writer->buffer[HEADER_WIDTH] = '\n';
+    writer->used = HEADER_WIDTH + 1;
+    writer->header = 1;
+}
+
+void row_writer_open_temp(RowWriter *writer, const char *tmp_dir) {
+    writer_init(writer, create_temp_file(tmp_dir), 0);
+}
+
+void row_writer_put(RowWriter *writer, const Row *row) {
+    if (WRITER_BUFFER - writer->used < MAX_ROW_TEXT) {
+        writer_flush(writer, 0);
+    }
+    writer->used = format_row(writer->buffer + writer->used, row) - writer->buffer;
+    writer->count++;
+}
+
+void row_writer_put_repeat(RowWriter *writer, const Row *row, long long count) {
+    char text[MAX_ROW_TEXT];
+    size_t length = format_row(text, row) - text;
+    for (long long k = 0; k < count; k++) {
+        if (WRITER_BUFFER - writer->used < MAX_ROW_TEXT) {
+            writer_flush(writer, 0);
+        }
+        memcpy(writer->buffer + writer->used, text, MAX_ROW_TEXT);
+        writer->used += length;
+    }
+    writer->count += count;
+}
+
+void row_writer_put_block(RowWriter *writer, int id, uint64_t left_begin, uint64_t left_end,
+                          uint64_t right_begin, uint64_t right_end) {
+    if (WRITER_BUFFER - writer->used < MAX_BLOCK_TEXT) {
+        writer_flush(writer, 0);
+    }
+    char *out = format_int(writer->buffer + writer->used, id);
+    *out++ = ' ';
+    out = format_u64(out, left_begin);
+    *out++ = '-';
+    out = format_u64(out, left_end);
+    *out++ = ' ';
+    out = format_u64(out, right_begin);
+    *out++ = '-';
+    out = format_u64(out, right_end);
+    *out++ = '\n';
+    writer->used = out - writer->buffer;
+    writer->count++;
+}
+
+void row_writer_append(RowWriter *writer, RowWriter *part) {
+    writer_flush(part, 1);
+    writer_flush(writer, 1);
+
+    loff_t offset = 0;
+    while (offset < part->written) {
+        ssize_t copied = copy_file_range(part->fd, &offset, writer->fd, NULL, part->written - offset, 0);
+        if (copied > 0) {
+            continue;
+        }
+        if (copied == -1 && errno == EINTR) {
+            continue;
+        }
+        if (copied == 0 || errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP) {
+            // Копирование через буфер, если ядро или файловая система не умеют copy_file_range
+            ssize_t n = pread(part->fd, writer->buffer, WRITER_BUFFER, offset);
+            if (n > 0) {
+                write_all(writer->fd, writer->buffer, n, "result");
+                offset += n;
+                continue;
+            }
+        }
+        fprintf(stderr, "Error: Cannot write result: %s\n", strerror(errno));
+        exit(1);
+    }
+    writer->written += part->written;
+    writer->count += part->count;
+
+    close(part->fd);
+    free(part->buffer);
+    part->buffer = NULL;
+}
+
+void row_writer_close(RowWriter *writer) {
+    writer_flush(writer, 1);
+    if (writer->header) {
+        char header[HEADER_WIDTH + 1];
+        snprintf(header, sizeof(header), "%-*lld", HEADER_WIDTH, writer->count);
+        if (pwrite(writer->fd, header, HEADER_WIDTH, 0) != HEADER_WIDTH) {
+            fprintf(stderr, "Error: Cannot write result\n");
+            exit(1);
+        }
+    }
+    if (close(writer->fd) != 0) {
+        fprintf(stderr, "Error: Cannot write result\n");
+        exit(1);
+    }
+    free(writer->buffer);
+    writer->buffer = NULL;
+}
@@ -0,0 +1,43 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "table.h"
+
+// Потоковая запись строк в текстовом формате таблицы. Строки форматируются собственным
+// преобразованием чисел в выровненный буфер и сбрасываются write() целыми блоками, поэтому
+// память не зависит от размера результата. С output_direct файл открывается с O_DIRECT
+// (мимо page cache), хвост, не кратный блоку, дописывается уже без него.
+// Число строк заранее неизвестно, поэтому место под заголовок резервируется пробелами и
+// заполняется при закрытии (fscanf("%d") пробелы пропускает)
+typedef struct {
+    int fd;
+    char *buffer;     // выровнен по блоку для O_DIRECT
+    size_t used;
+    off_t written;    // сколько байт уже в файле
+    int direct;       // fd сейчас в режиме O_DIRECT
+    int header;       // в начале файла зарезервирован заголовок
+    long long count;
+} RowWriter;
+
+// Открывать результат с O_DIRECT (--direct)
+extern int output_direct;
+
+void row_writer_open(RowWriter *writer, const char *filename);
+// Безымянный временный файл в tmp_dir без заголовка: часть результата одного потока
+void row_writer_open_temp(RowWriter *writer, const char *tmp_dir);
+void row_writer_put(RowWriter *writer, const Row *row);
+// Пишет строку count раз; форматируется она один раз
+void row_writer_put_repeat(RowWriter *writer, const Row *row, long long count);
+// Компактная строка "id left_begin-left_end right_begin-right_end": блок результата - все пары
+// строк из полуинтервалов отсортированных table1 и table2 (--compact)
+void row_writer_put_block(RowWriter *writer, int id, uint64_t left_begin, uint64_t left_end,
+                          uint64_t right_begin, uint64_t right_end);
+// Дописывает в конец writer содержимое part (copy_file_range, без копирования через память)
+// и закрывает part
+void row_writer_append(RowWriter *writer, RowWriter *part);
+void row_writer_close(RowWriter *writer);
+
+#endif
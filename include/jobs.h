@@ -0,0 +1,25 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <cstddef>
+#include <string>
+#include <sys/types.h>
+
+#include "stats.h"
+
+// Фоновые задания. pidfd каждого задания зарегистрирован в epoll рядом с дескриптором ввода,
+// поэтому завершение обрабатывается сразу и за O(1), а не опросом всех заданий перед приглашением.
+
+void jobs_init(int input_fd);
+// child: pid, команда, момент запуска и открытые счётчики perf
+void jobs_add(int pidfd, ChildStats child);
+// Блокируется до готовности ввода, по пути сообщая о завершившихся заданиях.
+// Возвращает true, если за время ожидания что-то было напечатано.
+bool jobs_wait_input();
+// Неблокирующая обработка завершившихся заданий
+void jobs_reap_ready();
+size_t jobs_count();
+// SIGTERM всем оставшимся, через 2 секунды - SIGKILL
+void jobs_shutdown();
+
+#endif // JOBS_H
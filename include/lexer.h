@@ -0,0 +1,23 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Однопроходный лексер строки: снимает экранирование '\', делит по пробелам и табам
+// и пишет NUL-терминированные токены в арену, которая переиспользуется между строками.
+// Результат - готовый argv: за последним токеном всегда лежит nullptr.
+// Токены действительны до следующего вызова tokenize().
+class Lexer {
+public:
+  std::span<char *> tokenize(std::string_view line);
+  bool background() const { return background_; }
+
+private:
+  std::vector<char> arena_;
+  std::vector<char *> tokens_;
+  bool background_ = false;
+};
+
+#endif // LEXER_H
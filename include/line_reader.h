@@ -0,0 +1,46 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Построчное чтение ввода шелла без копирования строк.
+// Обычные файлы отображаются через mmap целиком, пайпы и терминалы читаются блоками.
+// Если fd наследуется потомками (stdin, перенаправленный из файла), смещение fd ведётся как
+// у bash: после строки оно стоит на её конце, и команда, читающая stdin, видит остаток
+// скрипта, а следующая строка читается с того места, где команда остановилась.
+// Возвращаемый string_view действителен до следующего вызова next().
+class LineReader {
+public:
+  explicit LineReader(int fd);
+  ~LineReader();
+
+  LineReader(const LineReader &) = delete;
+  LineReader &operator=(const LineReader &) = delete;
+
+  bool next(std::string_view &line);
+  // Есть ли строка (или EOF), которую next() вернёт без блокирующего read()
+  bool ready() const;
+  bool failed() const { return failed_; }
+
+private:
+  bool fill();
+  void sync_offset();
+
+  static constexpr size_t kBlockSize = 64 * 1024;
+
+  int fd_;
+  const char *map_ = nullptr;
+  size_t map_size_ = 0;
+  size_t map_pos_ = 0;
+  std::vector<char> buffer_;
+  size_t begin_ = 0;
+  size_t end_ = 0;
+  bool seekable_ = false;
+  bool share_offset_ = false;  // смещение fd общее с запускаемыми командами
+  bool eof_ = false;
+  bool failed_ = false;
+};
+
+#endif // LINE_READER_H
@@ -0,0 +1,26 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <cstddef>
+#include <string>
+
+// Способ запуска внешних команд
+enum class LaunchMode {
+  Clone, // clone3 без флагов: полная копия адресного пространства (COW)
+  Spawn, // posix_spawn: CLONE_VM | CLONE_VFORK, без копирования страниц
+};
+
+struct ShellOptions {
+  LaunchMode launch_mode = LaunchMode::Clone;
+  bool stats = false;  // JSON-строки с rusage каждого потомка в stderr
+  bool perf = false;   // счётчики perf_event_open в тех же строках (включает stats)
+  size_t pipe_size = 0; // ёмкость пайпов конвейера (F_SETPIPE_SZ); 0 - системная по умолчанию (64 KiB)
+};
+
+extern ShellOptions shell_options;
+
+bool set_option(const std::string &name, const std::string &value);
+void print_options();
+const char *launch_mode_name(LaunchMode mode);
+
+#endif // OPTIONS_H
@@ -0,0 +1,12 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+// Builtin `parallel [-j N] FILE`: выполняет команды из FILE (по одной на строку),
+// держа не более N потомков одновременно. Вывод каждой задачи печатается в порядке
+// строк файла, в конце - пропускная способность и хвостовые задержки.
+// Возвращает 0, если все задачи успешны, 1 - если какая-то завершилась с ошибкой,
+// kParallelError - если не удалось запустить сами задачи (аргументы, файл).
+constexpr int kParallelError = 2;
+int run_parallel(char **argv);
+
+#endif // PARALLEL_H
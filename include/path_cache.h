@@ -0,0 +1,12 @@
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+// Хеш-таблица команд в духе builtin `hash` из bash: имя -> абсолютный путь.
+// Сбрасывается при изменении PATH и при изменении mtime каталогов из PATH.
+// Относительные элементы PATH (".", пустой) не кешируются и проверяются при каждом поиске.
+
+const char *resolve_command(const char *name);
+void path_cache_clear();
+void path_cache_print();
+
+#endif // PATH_CACHE_H
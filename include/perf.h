@@ -0,0 +1,36 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+#include "process.h"
+
+// Счётчики perf_event_open для одного потомка. Открываются на pid до exec с enable_on_exec,
+// поэтому считают только саму команду (и её потомков через inherit), без кода шелла между clone и exec.
+// Если аппаратные счётчики недоступны (виртуальная машина, нет PMU), используются программные события.
+
+constexpr size_t kPerfEvents = 5;
+
+struct PerfCounters {
+  int fds[kPerfEvents] = {-1, -1, -1, -1, -1};
+  int64_t values[kPerfEvents] = {-1, -1, -1, -1, -1}; // -1 - событие не открылось или не было запланировано
+  bool software = false; // открыт программный набор событий вместо аппаратного
+  bool opened = false;
+};
+
+// Включать ли счётчики для текущей строки: set perf on / --perf
+extern bool collect_perf;
+
+// Запуск внешней команды со счётчиками. Потомок ждёт на пайпе, пока родитель откроет счётчики
+// на его pid, поэтому всегда используется clone3: posix_spawn не даёт остановить потомка до exec.
+pid_t launch_counted(LaunchSpec &spec, PerfCounters &counters);
+// Читает значения (с поправкой на мультиплексирование) и закрывает дескрипторы; вызывать после wait
+void perf_read(PerfCounters &counters);
+// Сумма по стадиям конвейера
+void perf_add(PerfCounters &total, const PerfCounters &counters);
+// Печатает поле ,"perf":{...} строки статистики в stderr
+void perf_print(const PerfCounters &counters);
+
+#endif // PERF_H
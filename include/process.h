@@ -1,11 +1,35 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
-#include <string>
+#include <span>
+#include <string_view>
+#include <sys/types.h>
+#include <utility>
 #include <vector>
 
-long create_process();
-char **get_argv_ptr(const std::vector<std::string> &args);
-void free_argv(char **argv, size_t size);
+#include "options.h"
+
+// Оператор перенаправления и имя файла; указывают в арену лексера
+using Redirections = std::vector<std::pair<std::string_view, const char *>>;
+
+// Описание запускаемой команды: argv, концы пайпов и файловые перенаправления
+struct LaunchSpec {
+  char **argv = nullptr;
+  const char *path = nullptr; // путь из resolve_command(); nullptr - поиск по PATH через execvp
+  int stdin_fd = -1;
+  int stdout_fd = -1;
+  int stderr_fd = -1;
+  int *pidfd = nullptr; // если задан, сюда пишется pidfd потомка (или -1)
+  int start_fd = -1; // только для clone3: потомок ждёт EOF на этом дескрипторе перед exec
+  std::vector<int> close_fds;
+  Redirections redirections;
+};
+
+std::span<char *> parse_redirections(std::span<char *> args, Redirections &redirections);
+long create_process(int *pidfd = nullptr);
+pid_t launch_process(const LaunchSpec &spec, LaunchMode mode);
+pid_t launch_builtin(const LaunchSpec &spec, int (*builtin)(char **argv));
+bool create_pipe(int fds[2], size_t capacity);
+void apply_redirections_in_child(const Redirections &redirections);
 
 #endif //PROCESS_H
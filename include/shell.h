@@ -0,0 +1,22 @@
+#ifndef SHELL_H
+#define SHELL_H
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Выполнение разобранной строки. Вынесено из main.cpp, чтобы те же пути
+// запускались из shell_bench без интерактивного цикла.
+
+bool is_spec_command(std::string_view name);
+// false - ошибка самой команды; status - код завершения (у parallel - 1, если упала какая-то задача)
+bool exec_spec_commands(char **argv, int &status);
+// Возвращает код завершения команды (128 + сигнал, если потомок убит)
+int execute_command(std::span<char *> args, bool background = false);
+// Код завершения последней стадии
+int execute_pipeline(const std::vector<std::span<char *>> &commands);
+bool handle_or_command(std::span<char *> args);
+// Делит argv по "|" на месте: каждый "|" заменяется на nullptr и завершает argv своей команды
+std::vector<std::span<char *>> parse_pipeline(std::span<char *> args);
+
+#endif // SHELL_H
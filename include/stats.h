@@ -0,0 +1,40 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <string>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <vector>
+
+#include "perf.h"
+
+// Ресурсы, потраченные потомком: собираются через wait4 и печатаются в stderr
+// строками JSON (по одной на процесс), чтобы их можно было агрегировать между запусками.
+
+using StatsClock = std::chrono::steady_clock;
+
+// Печатать ли статистику для текущей строки: set stats on / --stats или префикс time
+extern bool collect_stats;
+
+struct ChildStats {
+  std::string command;
+  pid_t pid = -1;
+  int status = 0;
+  StatsClock::time_point start;
+  double wall_seconds = 0;
+  rusage usage{};
+  PerfCounters perf; // открываются только при set perf on
+};
+
+std::string command_line(char **argv);
+// wait4 с перезапуском при EINTR; options = 0 или WNOHANG. Возвращает pid, 0 или -1
+pid_t wait_child(ChildStats &child, int options = 0);
+// Ждёт все процессы по их pidfd (-1 - дождаться обычным wait4), фиксируя момент завершения каждого
+void wait_children(std::vector<ChildStats> &children, const std::vector<int> &pidfds);
+
+// type: "command", "job", "stage" (index - номер стадии конвейера)
+void emit_stats(const char *type, const ChildStats &child, int index = -1);
+void emit_pipeline_stats(const std::vector<ChildStats> &stages, double wall_seconds);
+
+#endif // STATS_H
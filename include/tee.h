@@ -0,0 +1,10 @@
+#ifndef TEE_H
+#define TEE_H
+
+// Встроенный `tee [-a] [FILE...]` для конвейеров: дублирует stdin в stdout и файлы
+// через tee(2)/splice(2), не копируя данные в пространство пользователя.
+// Если stdin или stdout - не пайп или файлов больше одного, работает как обычный read/write tee.
+bool is_builtin_tee(char **argv);
+int builtin_tee(char **argv);
+
+#endif // TEE_H
@@ -6,5 +6,6 @@
 
 std::vector<std::string> split(const std::string &s, char delim);
 std::string pwd();
+double percentile(const std::vector<double> &sorted, double p);
 
 #endif // UTIL_H
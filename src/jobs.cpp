@@ -0,0 +1,219 @@
+#include "jobs.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "stats.h"
+
+using namespace std;
+
+namespace {
+  constexpr int kMaxEvents = 64;
+  // epoll_event.data.u64 хранит pid задания; ввод помечается отдельным значением
+  constexpr uint64_t kInputTag = ~0ull;
+
+  struct Job {
+    int pidfd = -1; // -1, если pidfd получить не удалось (старое ядро, исчерпан лимит дескрипторов)
+    ChildStats stats;
+    bool emit_stats = false;
+  };
+
+  int epoll_fd = -1;
+  bool input_pollable = false;
+  unordered_map<pid_t, Job> jobs;
+  size_t jobs_without_pidfd = 0;
+
+  void report(const Job &job) {
+    const ChildStats &child = job.stats;
+    if (WIFEXITED(child.status)) {
+      cout << "[Background process " << child.pid << " finished with status " << WEXITSTATUS(child.status) << "]"
+           << endl;
+    } else {
+      cout << "[Background process " << child.pid << " terminated by signal " << WTERMSIG(child.status) << "]"
+           << endl;
+    }
+    if (job.emit_stats) {
+      emit_stats("job", child);
+    }
+  }
+
+  void forget(const unordered_map<pid_t, Job>::iterator it) {
+    if (it->second.pidfd != -1) {
+      epoll_ctl(epoll_fd, EPOLL_CTL_DEL, it->second.pidfd, nullptr);
+      close(it->second.pidfd);
+    } else {
+      --jobs_without_pidfd;
+    }
+    jobs.erase(it);
+  }
+
+  // wait4 без блокировки: задание могло ещё не завершиться
+  bool reap(const unordered_map<pid_t, Job>::iterator it) {
+    if (wait_child(it->second.stats, WNOHANG) <= 0) {
+      return false;
+    }
+    report(it->second);
+    forget(it);
+    return true;
+  }
+
+  // Запасной путь для заданий без pidfd: опрос только их, как раньше
+  bool reap_without_pidfd() {
+    bool reaped = false;
+    for (auto it = jobs.begin(); jobs_without_pidfd > 0 && it != jobs.end();) {
+      const auto current = it++;
+      if (current->second.pidfd == -1 && reap(current)) {
+        reaped = true;
+      }
+    }
+    return reaped;
+  }
+
+  // Возвращает true, если ввод готов к чтению
+  bool dispatch(const epoll_event *events, const int count, bool &printed) {
+    bool input_ready = false;
+    for (int i = 0; i < count; ++i) {
+      if (events[i].data.u64 == kInputTag) {
+        input_ready = true;
+      } else if (const auto it = jobs.find(static_cast<pid_t>(events[i].data.u64)); it != jobs.end() && reap(it)) {
+        printed = true;
+      }
+    }
+    return input_ready;
+  }
+}
+
+void jobs_init(const int fd) {
+  // Каждое задание держит pidfd: поднимаем мягкий лимит дескрипторов до жёсткого
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd == -1) {
+    perror("epoll_create1");
+    exit(1);
+  }
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.u64 = kInputTag;
+  // Обычные файлы epoll не поддерживает (EPERM): такой ввод всегда готов
+  input_pollable = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void jobs_add(int pidfd, ChildStats child) {
+  const pid_t pid = child.pid;
+  if (pidfd != -1) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = static_cast<uint64_t>(pid);
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pidfd, &event) == -1) {
+      close(pidfd);
+      pidfd = -1;
+    }
+  }
+  if (pidfd == -1) {
+    ++jobs_without_pidfd;
+  }
+  Job &job = jobs[pid];
+  job.pidfd = pidfd;
+  job.stats = std::move(child);
+  job.emit_stats = collect_stats;
+}
+
+bool jobs_wait_input() {
+  bool printed = reap_without_pidfd();
+  if (!input_pollable) {
+    jobs_reap_ready();
+    return printed;
+  }
+
+  epoll_event events[kMaxEvents];
+  while (true) {
+    // Задания без pidfd опрашиваются раз в 100 мс, остальные будят epoll сами
+    const int timeout = jobs_without_pidfd > 0 ? 100 : -1;
+    const int count = epoll_wait(epoll_fd, events, kMaxEvents, timeout);
+    if (count == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("epoll_wait");
+      return printed;
+    }
+    printed |= reap_without_pidfd();
+    if (dispatch(events, count, printed)) {
+      return printed;
+    }
+  }
+}
+
+void jobs_reap_ready() {
+  if (jobs.empty()) {
+    return;
+  }
+  reap_without_pidfd();
+  epoll_event events[kMaxEvents];
+  int count;
+  bool printed = false;
+  do {
+    count = epoll_wait(epoll_fd, events, kMaxEvents, 0);
+    if (count > 0) {
+      dispatch(events, count, printed);
+    }
+  } while (count == kMaxEvents);
+}
+
+size_t jobs_count() {
+  return jobs.size();
+}
+
+void jobs_shutdown() {
+  jobs_reap_ready();
+  for (const auto &[pid, job] : jobs) {
+    cout << "Sending SIGTERM to background process " << pid << endl;
+    kill(pid, SIGTERM);
+  }
+
+  // Даем процессам до 2 секунд на корректное завершение, просыпаясь на каждое завершение
+  if (!jobs.empty()) {
+    cout << "Waiting for background processes to terminate..." << endl;
+    const auto deadline = chrono::steady_clock::now() + chrono::seconds(2);
+    epoll_event events[kMaxEvents];
+    while (!jobs.empty()) {
+      const auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+      if (left <= 0) {
+        break;
+      }
+      const int count = epoll_wait(epoll_fd, events, kMaxEvents, jobs_without_pidfd > 0 ? min<long>(left, 100) : left);
+      bool printed = false;
+      if (count > 0) {
+        dispatch(events, count, printed);
+      }
+      reap_without_pidfd();
+    }
+  }
+
+  // Принудительно завершаем оставшиеся процессы
+  while (!jobs.empty()) {
+    const auto it = jobs.begin();
+    const pid_t pid = it->first;
+    cout << "Sending SIGKILL to background process " << pid << endl;
+    kill(pid, SIGKILL);
+    wait_child(it->second.stats);
+    cout << "[Background process " << pid << " killed]" << endl;
+    forget(it);
+  }
+}
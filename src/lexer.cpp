@@ -0,0 +1,54 @@
+#include "lexer.h"
+
+std::span<char *> Lexer::tokenize(const std::string_view line) {
+  // k токенов из n символов строки занимают не больше n + 1 байт вместе с NUL
+  if (arena_.size() < line.size() + 1) {
+    arena_.resize(line.size() + 1);
+  }
+  tokens_.clear();
+  background_ = false;
+
+  char *out = arena_.data();
+  char *token = nullptr;
+  // Последний записанный байт пришёл из экранирования: "\&" - это символ, а не фоновый запуск
+  bool last_escaped = false;
+  for (size_t i = 0; i < line.size(); ++i) {
+    char c = line[i];
+    bool escaped = false;
+    if (c == '\\' && i + 1 < line.size()) {
+      c = line[++i];
+      escaped = true;
+    } else if (c == ' ' || c == '\t') {
+      if (token != nullptr) {
+        *out++ = '\0';
+        token = nullptr;
+      }
+      continue;
+    }
+    if (token == nullptr) {
+      token = out;
+      tokens_.push_back(token);
+    }
+    *out++ = c;
+    last_escaped = escaped;
+  }
+  if (token != nullptr) {
+    *out = '\0';
+  }
+
+  // Завершающий '&' (отдельным токеном или приклеенный к последнему) - фоновый запуск
+  if (!tokens_.empty()) {
+    char *last = tokens_.back();
+    const size_t len = std::string_view(last).size();
+    if (last[len - 1] == '&' && !last_escaped) {
+      background_ = true;
+      last[len - 1] = '\0';
+      if (len == 1) {
+        tokens_.pop_back();
+      }
+    }
+  }
+
+  tokens_.push_back(nullptr);
+  return {tokens_.data(), tokens_.size() - 1};
+}
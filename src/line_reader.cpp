@@ -0,0 +1,130 @@
+#include "line_reader.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LineReader::LineReader(const int fd) : fd_(fd) {
+  seekable_ = lseek(fd, 0, SEEK_CUR) != -1;
+  const int fd_flags = fcntl(fd, F_GETFD);
+  share_offset_ = seekable_ && fd_flags != -1 && (fd_flags & FD_CLOEXEC) == 0;
+
+  struct stat st{};
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    const off_t offset = lseek(fd, 0, SEEK_CUR);
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+      madvise(map, st.st_size, MADV_SEQUENTIAL);
+      map_ = static_cast<const char *>(map);
+      map_size_ = st.st_size;
+      map_pos_ = offset > 0 ? offset : 0;
+      return;
+    }
+  }
+  buffer_.resize(kBlockSize);
+}
+
+LineReader::~LineReader() {
+  if (map_ != nullptr) {
+    munmap(const_cast<char *>(map_), map_size_);
+  }
+}
+
+bool LineReader::next(std::string_view &line) {
+  if (map_ != nullptr) {
+    // Команда могла дочитать stdin дальше (cat, read): продолжаем с её смещения
+    if (share_offset_) {
+      if (const off_t offset = lseek(fd_, 0, SEEK_CUR); offset != -1) {
+        map_pos_ = offset;
+      }
+    }
+    if (map_pos_ >= map_size_) {
+      return false;
+    }
+    const char *start = map_ + map_pos_;
+    const size_t left = map_size_ - map_pos_;
+    const auto *nl = static_cast<const char *>(memchr(start, '\n', left));
+    const size_t len = nl != nullptr ? nl - start : left;
+    line = std::string_view(start, len);
+    map_pos_ += nl != nullptr ? len + 1 : len;
+    sync_offset();
+    return true;
+  }
+
+  size_t scanned = begin_;
+  while (true) {
+    const char *start = buffer_.data() + begin_;
+    if (const auto *nl = static_cast<const char *>(memchr(buffer_.data() + scanned, '\n', end_ - scanned))) {
+      line = std::string_view(start, nl - start);
+      begin_ = nl - buffer_.data() + 1;
+      sync_offset();
+      return true;
+    }
+    if (eof_) {
+      if (begin_ == end_) {
+        return false;
+      }
+      // Последняя строка без завершающего '\n'
+      line = std::string_view(start, end_ - begin_);
+      begin_ = end_;
+      return true;
+    }
+    scanned = end_ - begin_;
+    if (!fill()) {
+      eof_ = true;
+    }
+  }
+}
+
+bool LineReader::ready() const {
+  // Из файла read() не блокируется
+  if (map_ != nullptr || seekable_ || eof_ || failed_) {
+    return true;
+  }
+  return memchr(buffer_.data() + begin_, '\n', end_ - begin_) != nullptr;
+}
+
+// Сдвигает непрочитанный хвост в начало буфера и дочитывает следующий блок
+bool LineReader::fill() {
+  if (begin_ > 0) {
+    memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+    end_ -= begin_;
+    begin_ = 0;
+  }
+  if (end_ == buffer_.size()) {
+    buffer_.resize(buffer_.size() * 2);
+  }
+  while (true) {
+    const ssize_t n = read(fd_, buffer_.data() + end_, buffer_.size() - end_);
+    if (n > 0) {
+      end_ += n;
+      return true;
+    }
+    if (n == -1 && errno == EINTR) {
+      continue;
+    }
+    if (n == -1) {
+      perror("read");
+      failed_ = true;
+    }
+    return false;
+  }
+}
+
+// Возвращает смещение fd на конец прочитанной строки. Прочитанный блоками хвост
+// отбрасывается и будет прочитан заново: строка line при этом остаётся в буфере
+void LineReader::sync_offset() {
+  if (!share_offset_) {
+    return;
+  }
+  if (map_ != nullptr) {
+    lseek(fd_, static_cast<off_t>(map_pos_), SEEK_SET);
+    return;
+  }
+  lseek(fd_, -static_cast<off_t>(end_ - begin_), SEEK_CUR);
+  begin_ = end_ = 0;
+}
@@ -1,23 +1,21 @@
-#include <chrono>
 #include <csignal>
 #include <cstring>
 #include <iostream>
-#include <set>
 #include <string>
-#include <sys/wait.h>
 #include <unistd.h>
-#include <vector>
 #include <fcntl.h>
+#include <getopt.h>
 
-#include "process.h"
-#include "util.h"
+#include "lexer.h"
+#include "line_reader.h"
+#include "jobs.h"
+#include "options.h"
+#include "perf.h"
+#include "shell.h"
+#include "stats.h"
 
 using namespace std;
 
-const set<string> specCommands = {"cd", "export", "unset"};
-const set<string> redirOperators = {">", "<", ">>"};
-vector<pid_t> background_processes;
-
 void handle_signal(const int sig) {
   if (sig == SIGINT) {
     return;
@@ -27,462 +25,122 @@ void handle_signal(const int sig) {
   }
 }
 
-void cleanup_background_processes() {
-    for (auto it = background_processes.begin(); it != background_processes.end(); ) {
-        int status;
-        if (waitpid(*it, &status, WNOHANG) > 0) {
-            cout << "[Background process " << *it << " finished with status " << WEXITSTATUS(status) << "]" << endl;
-            it = background_processes.erase(it);
-        } else {
-            ++it;
-        }
-    }
+void print_usage(const char *program_name) {
+    cout << "Usage: " << program_name << " [OPTIONS]" << endl;
+    cout << "Options:" << endl;
+    cout << "  -f, --file FILE     Read commands from FILE instead of stdin" << endl;
+    cout << "  -l, --launch MODE   Process launch mode: clone (default) or spawn" << endl;
+    cout << "  -p, --pipe-size N   Pipeline pipe capacity in bytes, K/M suffix allowed" << endl;
+    cout << "  -s, --stats         Print rusage of every child as JSON lines to stderr" << endl;
+    cout << "  -P, --perf          Add perf_event_open counters (cycles, IPC, cache misses) to --stats" << endl;
+    cout << "  -h, --help          Show this help message" << endl;
 }
 
-bool exec_spec_commands(char **argv) {
-  if (string(argv[0]) == "cd") {
-    string path = getenv("HOME");
-
-    if (argv[1] == nullptr) {
-      argv[1] = path.data();
-    }
-    if (chdir(argv[1]) != 0) {
-      perror("chdir");
-      cerr << "dir:" << argv[1] << endl;
-      return false;
-    }
-  } else if (string(argv[0]) == "export") {
-    if (argv[1] == nullptr || strchr(argv[1], '=') == nullptr) {
-      cerr << "export: invalid argument" << endl;
-      return false;
-    }
-    if (putenv(argv[1]) != 0) {
-      cerr << "Error setting environment variable: " << argv[1] << endl;
-      return false;
-    }
-  } else if (string(argv[0]) == "unset") {
-    if (argv[1] == nullptr) {
-      cerr << "unset: missing argument" << endl;
-      return false;
-    }
-    if (unsetenv(argv[1]) != 0) {
-      cerr << "Error unsetting environment variable: " << argv[1] << endl;
-      return false;
-    }
-  }
-  return true;
-}
-
-void apply_redirections_in_child(const vector<pair<string, string>>& redirections) {
-    for (const auto& redir : redirections) {
-        if (redir.first == ">") {
-            // Перенаправление вывода (перезапись)
-            int fd = open(redir.second.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
-            if (fd == -1) {
-                cout << "open error: " << redir.second << endl;
-                exit(1);
-            }
-            if (dup2(fd, STDOUT_FILENO) == -1) {
-                cout << "dup2 error" << endl;
-                close(fd);
-                exit(1);
-            }
-            close(fd);
-        } else if (redir.first == ">>") {
-            // Перенаправление вывода (добавление)
-            int fd = open(redir.second.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
-            if (fd == -1) {
-                cout << "open error: " << redir.second << endl;
-                exit(1);
-            }
-            if (dup2(fd, STDOUT_FILENO) == -1) {
-                cout << "dup2 error" << endl;
-                close(fd);
-                exit(1);
-            }
-            close(fd);
-        } else if (redir.first == "<") {
-            // Перенаправление ввода
-            int fd = open(redir.second.c_str(), O_RDONLY);
-            if (fd == -1) {
-                cout << "open error: " << redir.second << endl;
-                exit(1);
-            }
-            if (dup2(fd, STDIN_FILENO) == -1) {
-                cout << "dup2 error" << endl;
-                close(fd);
-                exit(1);
-            }
-            close(fd);
-        }
-    }
-}
-
-int child_routine(void *arg) {
-  if (const auto argv = static_cast<char **>(arg); execvp(argv[0], argv) == -1) {
-    cerr << "Command not found"<< endl;
-    exit(1);
-  }
-  return 0;
-}
-
-// Функция для парсинга перенаправлений
-pair<vector<string>, vector<pair<string, string>>> parse_redirections(const vector<string>& args) {
-    vector<string> command_args;
-    vector<pair<string, string>> redirections;
-    
-    for (size_t i = 0; i < args.size(); ++i) {
-        if (redirOperators.count(args[i])) {
-            if (i + 1 >= args.size()) {
-                cout << "Syntax error: missing filename for " << args[i] << endl;
-                return {command_args, redirections};
-            }
-            redirections.push_back({args[i], args[i + 1]});
-            ++i; // Пропускаем имя файла
-        } else {
-            command_args.push_back(args[i]);
-        }
-    }
-    
-    return {command_args, redirections};
-}
-
-int execute_command(vector<string> args, bool background = false) {
-    if (args.empty()) {
-      return 0;
-    }
-  
-    // Парсим перенаправления
-    auto [command_args, redirections] = parse_redirections(args);
-    
-    if (command_args.empty()) {
-        cout << "Syntax error: command expected" << endl;
-        return 1;
-    }
-  
-    char **argv = get_argv_ptr(command_args);
-  
-    if (string(argv[0]) == "exit") {
-      free_argv(argv, command_args.size());
-      exit(EXIT_SUCCESS);
-    }
-  
-    if (specCommands.contains(argv[0])) {
-      // Специальные команды не поддерживают перенаправления
-      if (!redirections.empty()) {
-          cout << "Special commands do not support redirections" << endl;
-          free_argv(argv, command_args.size());
-          return 1;
-      }
-      bool success = exec_spec_commands(argv);
-      free_argv(argv, command_args.size());
-      return success ? 0 : 1;
-    }
-  
-    // 1. Сначала создаем дочерний процесс
-    const long pid = create_process();
-    if (pid == -1) {
-      cout << "create_process error" << endl;
-      free_argv(argv, command_args.size());
-      return 1;
-    }
-  
-    if (pid == 0) {
-      // 2. В дочернем процессе применяем перенаправления (если есть)
-      if (!redirections.empty()) {
-          apply_redirections_in_child(redirections);
-      }
-      
-      // 3. Затем выполняем команду
-      child_routine(argv);
-      
-      // Если child_routine вернула управление, значит произошла ошибка
-      exit(1);
-    }
-  
-    if (background) {
-      background_processes.push_back(pid);
-      cout << "[Background process started with PID: " << pid << "]" << endl;
-      free_argv(argv, command_args.size());
-      return 0;
-    }
-  
-    // КРИТИЧЕСКОЕ ИСПРАВЛЕНИЕ: правильно ждем завершения дочернего процесса
-    int status;
-    pid_t result;
-    do {
-        result = waitpid(static_cast<pid_t>(pid), &status, 0);
-    } while (result == -1 && errno == EINTR); // Перезапускаем если прервано сигналом
-  
-    if (result == -1) {
-        cout << "waitpid error" << endl;
-        free_argv(argv, command_args.size());
-        return 1;
-    }
-  
-    free_argv(argv, command_args.size());
-    
-    if (WIFEXITED(status)) {
-        return WEXITSTATUS(status);
-    } else if (WIFSIGNALED(status)) {
-        cout << "Process terminated by signal: " << WTERMSIG(status) << endl;
-        return 128 + WTERMSIG(status);
-    } else {
-        return 1;
-    }
-  }
-
-// Обновленная функция для конвейеров
-int execute_pipeline(vector<vector<string>> commands) {
-    if (commands.empty()) {
-        return 0;
-    }
-
-    int num_commands = commands.size();
-    vector<pid_t> pids(num_commands);
-    
-    // Создаем пайпы для связи между процессами
-    vector<vector<int>> pipes(num_commands - 1, vector<int>(2));
-    
-    for (int i = 0; i < num_commands - 1; ++i) {
-        if (pipe(pipes[i].data()) == -1) {
-            perror("pipe");
-            return 1;
+int main(int argc, char *argv[]) {
+    static option long_options[] = {
+        {"file", required_argument, nullptr, 'f'},
+        {"launch", required_argument, nullptr, 'l'},
+        {"pipe-size", required_argument, nullptr, 'p'},
+        {"stats", no_argument, nullptr, 's'},
+        {"perf", no_argument, nullptr, 'P'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    const char *script_path = nullptr;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:l:p:sPh", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'f':
+                script_path = optarg;
+                break;
+            case 'l':
+                if (!set_option("launch", optarg)) {
+                    return 1;
+                }
+                break;
+            case 'p':
+                if (!set_option("pipe-size", optarg)) {
+                    return 1;
+                }
+                break;
+            case 's':
+                shell_options.stats = true;
+                break;
+            case 'P':
+                shell_options.perf = true;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
         }
     }
 
-    auto start = chrono::high_resolution_clock::now();
-
-    // Создаем процессы для каждой команды в конвейере
-    for (int i = 0; i < num_commands; ++i) {
-        pids[i] = create_process();
-        
-        if (pids[i] == -1) {
-            perror("fork");
+    int input_fd = STDIN_FILENO;
+    if (script_path != nullptr) {
+        input_fd = open(script_path, O_RDONLY | O_CLOEXEC);
+        if (input_fd == -1) {
+            perror(script_path);
             return 1;
         }
-        
-        if (pids[i] == 0) { // Дочерний процесс
-            // 1. Парсим перенаправления для этой команды
-            auto [command_args, redirections] = parse_redirections(commands[i]);
-            
-            // 2. Подключаем пайпы (это имеет приоритет над файловыми перенаправлениями)
-            if (i > 0) {
-                dup2(pipes[i-1][0], STDIN_FILENO);
-            }
-            if (i < num_commands - 1) {
-                dup2(pipes[i][1], STDOUT_FILENO);
-            }
-            
-            // Закрываем все файловые дескрипторы пайпов
-            for (auto &pipe : pipes) {
-                close(pipe[0]);
-                close(pipe[1]);
-            }
-            
-            // 3. Применяем файловые перенаправления (если есть)
-            if (!redirections.empty()) {
-                apply_redirections_in_child(redirections);
-            }
-            
-            // 4. Выполняем команду
-            char **argv = get_argv_ptr(command_args);
-            if (execvp(argv[0], argv) == -1) {
-                perror("execvp");
-                free_argv(argv, command_args.size());
-                exit(1);
-            }
-        }
     }
-
-    // Закрываем все пайпы в родительском процессе
-    for (auto &pipe : pipes) {
-        close(pipe[0]);
-        close(pipe[1]);
-    }
-
-    // Ждем завершения всех процессов
-    int status = 0;
-    for (int i = 0; i < num_commands; ++i) {
-        pid_t result;
-        do {
-            result = waitpid(pids[i], &status, 0);
-        } while (result == -1 && errno == EINTR);
-        
-        if (result == -1) {
-            perror("waitpid");
-        }
-    }
-
-    auto end = chrono::high_resolution_clock::now();
-    auto elapsed_ms = chrono::duration_cast<chrono::milliseconds>(end - start);
-    //cout << "Pipeline elapsed time: " << elapsed_ms.count() << " ms" << endl;
-    
-    if (WIFEXITED(status)) {
-        return WEXITSTATUS(status);
-    } else {
-        return 1;
-    }
-}
-
-bool handle_or_command(char** args, size_t arg_count) {
-    size_t or_pos = 0;
-    bool found_or = false;
-    
-    for (size_t i = 0; i < arg_count; ++i) {
-        if (string(args[i]) == "||") {
-            or_pos = i;
-            found_or = true;
-            break;
-        }
-    }
-    
-    if (!found_or || or_pos == 0 || or_pos >= arg_count - 1) {
-        cerr << "||: invalid syntax. Usage: command1 || command2" << endl;
-        return false;
-    }
-
-    vector<string> first_command;
-    for (size_t i = 0; i < or_pos; ++i) {
-        first_command.push_back(args[i]);
-    }
-
-    vector<string> second_command;
-    for (size_t i = or_pos + 1; i < arg_count; ++i) {
-        second_command.push_back(args[i]);
-    }
-
-    auto start = chrono::high_resolution_clock::now();
-    int exit_code = execute_command(first_command);
-    auto end = chrono::high_resolution_clock::now();
-    auto elapsed_ms = chrono::duration_cast<chrono::milliseconds>(end - start);
-    
-   // cout << "First command elapsed time: " << elapsed_ms.count() << " ms" << endl;
-    //cout << "First command exit code: " << exit_code << endl;
-
-    if (exit_code != 0) {
-        start = chrono::high_resolution_clock::now();
-        exit_code = execute_command(second_command);
-        end = chrono::high_resolution_clock::now();
-        elapsed_ms = chrono::duration_cast<chrono::milliseconds>(end - start);
-        
-        //cout << "Second command elapsed time: " << elapsed_ms.count() << " ms" << endl;
-        //cout << "Second command exit code: " << exit_code << endl;
-    }
-
-    return true;
-}
-
-vector<vector<string>> parse_pipeline(const vector<string>& args) {
-    vector<vector<string>> commands;
-    vector<string> current_command;
-    
-    for (const auto& arg : args) {
-        if (arg == "|") {
-            if (!current_command.empty()) {
-                commands.push_back(current_command);
-                current_command.clear();
-            }
-        } else {
-            current_command.push_back(arg);
-        }
-    }
-    
-    if (!current_command.empty()) {
-        commands.push_back(current_command);
-    }
-    
-    return commands;
-}
-
-int main() {
-    string input;
-    bool interactive = isatty(STDIN_FILENO);
+    bool interactive = script_path == nullptr && isatty(STDIN_FILENO);
+    LineReader reader(input_fd);
+    Lexer lexer;
+    jobs_init(input_fd);
+    string_view input;
 
     signal(SIGINT, handle_signal);
     signal(SIGQUIT, handle_signal);
 
     while (true) {
-        cleanup_background_processes();
-        
         // Выводим приглашение только в интерактивном режиме
         if (interactive) {
             cout << "$ ";
             cout.flush();
         }
         
-        // Чтение ввода с проверкой на Ctrl+D (EOF)
-        if (!getline(cin, input)) {
-            if (cin.eof()) {
-                // Обнаружен Ctrl+D - выходим из shell
-                break;
-            } else {
-                // Другая ошибка ввода
-                cerr << "Input error occurred" << endl;
-                cin.clear(); // Сбрасываем флаги ошибок
-                continue;
+        // Пока строки нет, ждём ввод в epoll вместе с pidfd фоновых заданий:
+        // о завершении задания сообщаем сразу, а не перед следующим приглашением
+        if (reader.ready()) {
+            jobs_reap_ready();
+        } else {
+            while (jobs_wait_input() && interactive && !reader.ready()) {
+                cout << "$ ";
+                cout.flush();
             }
         }
         
-        // Обработка экранированных символов
-        string cleaned_input;
-        for (size_t i = 0; i < input.length(); ++i) {
-            if (input[i] == '\\' && i + 1 < input.length()) {
-                cleaned_input += input[++i];
-            } else {
-                cleaned_input += input[i];
+        // Чтение ввода с проверкой на Ctrl+D (EOF)
+        if (!reader.next(input)) {
+            if (reader.failed()) {
+                cerr << "Input error occurred" << endl;
             }
+            break;
         }
         
-        // УДАЛЯЕМ ПРОБЕЛЫ В НАЧАЛЕ И КОНЦЕ СТРОКИ
-        size_t trim_start = cleaned_input.find_first_not_of(" \t");
-        if (trim_start == string::npos) {
-            // Строка состоит только из пробелов
-            continue;
-        }
-        size_t trim_end = cleaned_input.find_last_not_of(" \t");
-        cleaned_input = cleaned_input.substr(trim_start, trim_end - trim_start + 1);
-        
-        if (cleaned_input.empty()) {
-            continue;
-        }
+        // Разбивка на аргументы: токены пишутся в арену лексера и сразу образуют argv
+        auto args = lexer.tokenize(input);
+        bool background = lexer.background();
 
-        // Проверка на фоновое выполнение
-        bool background = false;
-        if (!cleaned_input.empty() && cleaned_input.back() == '&') {
-            background = true;
-            cleaned_input.pop_back();
-            // Убираем пробелы перед &
-            while (!cleaned_input.empty() && (cleaned_input.back() == ' ' || cleaned_input.back() == '\t')) {
-                cleaned_input.pop_back();
-            }
+        // time <команда>: статистика только для этой строки
+        collect_perf = shell_options.perf;
+        collect_stats = shell_options.stats || collect_perf;
+        if (!args.empty() && strcmp(args[0], "time") == 0) {
+            collect_stats = true;
+            args = args.subspan(1);
         }
-
-        // Разбивка на аргументы
-        auto args = split(cleaned_input, ' ');
         if (args.empty()) {
             continue;
         }
 
-        // УДАЛЯЕМ ПУСТЫЕ АРГУМЕНТЫ (если split возвращает пустые строки)
-        vector<string> filtered_args;
-        for (const auto& arg : args) {
-            if (!arg.empty()) {
-                filtered_args.push_back(arg);
-            }
-        }
-        
-        if (filtered_args.empty()) {
-            continue;
-        }
-
-        // ДАЛЕЕ ИСПОЛЬЗУЕМ filtered_args вместо args
-        auto args_to_use = filtered_args;
-
         // Проверка на конвейер
         bool has_pipe = false;
-        for (const auto& arg : args_to_use) {
-            if (arg == "|") {
+        for (const char *arg : args) {
+            if (strcmp(arg, "|") == 0) {
                 has_pipe = true;
                 break;
             }
@@ -490,8 +148,8 @@ int main() {
 
         // Проверка на оператор ИЛИ
         bool has_or = false;
-        for (const auto& arg : args_to_use) {
-            if (arg == "||") {
+        for (const char *arg : args) {
+            if (strcmp(arg, "||") == 0) {
                 has_or = true;
                 break;
             }
@@ -499,7 +157,7 @@ int main() {
 
         // Обработка конвейера
         if (has_pipe) {
-            auto commands = parse_pipeline(args_to_use);
+            auto commands = parse_pipeline(args);
             if (commands.size() < 2) {
                 cerr << "Invalid pipeline syntax" << endl;
                 continue;
@@ -508,8 +166,8 @@ int main() {
             // Проверка специальных команд в конвейере
             bool invalid_special_command = false;
             for (const auto& cmd : commands) {
-                if (!cmd.empty() && specCommands.contains(cmd[0])) {
-                    cerr << "Special commands (cd, export, unset) cannot be used in pipeline" << endl;
+                if (is_spec_command(cmd[0])) {
+                    cerr << "Special command " << cmd[0] << " cannot be used in pipeline" << endl;
                     invalid_special_command = true;
                     break;
                 }
@@ -527,55 +185,38 @@ int main() {
             continue;
         }
 
-        // Подготовка аргументов для выполнения
-        char **argv = get_argv_ptr(args_to_use);
-        size_t arg_count = args_to_use.size();
+        char **argv = args.data();
 
         // Обработка оператора ИЛИ
         if (has_or) {
             if (background) {
                 cerr << "Background execution not supported for || operator" << endl;
-                free_argv(argv, arg_count);
                 continue;
             }
-            handle_or_command(argv, arg_count);
-            free_argv(argv, arg_count);
+            handle_or_command(args);
             continue;
         }
 
         // Обработка команды exit
         if (string(argv[0]) == "exit") {
-            free_argv(argv, args_to_use.size());
             break;
         }
 
         // Обработка специальных команд
-        if (specCommands.contains(argv[0])) {
+        if (is_spec_command(argv[0])) {
             if (background) {
                 cerr << "Background execution not supported for special commands" << endl;
-                free_argv(argv, args_to_use.size());
                 continue;
             }
-            if (!exec_spec_commands(argv)) {
+            int status = 0;
+            if (!exec_spec_commands(argv, status)) {
                 cerr << "Error executing special command: " << argv[0] << endl;
             }
-            free_argv(argv, args_to_use.size());
             continue;
         }
 
         // Выполнение обычной команды
-        auto cmd_start = chrono::high_resolution_clock::now();
-        int exit_code = execute_command(args_to_use, background);
-        auto cmd_end = chrono::high_resolution_clock::now();
-        
-        // Вывод времени выполнения только для foreground процессов в интерактивном режиме
-        if (!background && interactive) {
-            auto elapsed_ms = chrono::duration_cast<chrono::milliseconds>(cmd_end - cmd_start);
-            // Раскомментируйте если нужно показывать время выполнения
-            // cout << "Elapsed time: " << elapsed_ms.count() << " ms" << endl;
-        }
-
-        free_argv(argv, args_to_use.size());
+        execute_command(args, background);
         
         // НЕ ВЫВОДИМ ПРИГЛАШЕНИЕ ЗДЕСЬ!
         // Приглашение будет выведено в начале следующей итерации цикла
@@ -583,48 +224,7 @@ int main() {
 
     // Cleanup только в интерактивном режиме
     if (interactive) {
-        // Завершаем все фоновые процессы
-        for (auto it = background_processes.begin(); it != background_processes.end(); ) {
-            int status;
-            pid_t pid = *it;
-            
-            // Проверяем, завершился ли процесс
-            if (waitpid(pid, &status, WNOHANG) > 0) {
-                cout << "[Background process " << pid << " already finished]" << endl;
-                it = background_processes.erase(it);
-            } else {
-                // Процесс еще работает, отправляем SIGTERM
-                cout << "Sending SIGTERM to background process " << pid << endl;
-                kill(pid, SIGTERM);
-                ++it;
-            }
-        }
-        
-        // Даем процессам время на корректное завершение
-        if (!background_processes.empty()) {
-            cout << "Waiting for background processes to terminate..." << endl;
-            sleep(2);
-        }
-        
-        // Принудительно завершаем оставшиеся процессы
-        for (auto it = background_processes.begin(); it != background_processes.end(); ) {
-            int status;
-            pid_t pid = *it;
-            
-            if (waitpid(pid, &status, WNOHANG) > 0) {
-                cout << "[Background process " << pid << " terminated]" << endl;
-                it = background_processes.erase(it);
-            } else {
-                // Процесс все еще жив, отправляем SIGKILL
-                cout << "Sending SIGKILL to background process " << pid << endl;
-                kill(pid, SIGKILL);
-                
-                // Ждем завершения
-                waitpid(pid, &status, 0);
-                cout << "[Background process " << pid << " killed]" << endl;
-                it = background_processes.erase(it);
-            }
-        }
+        jobs_shutdown();
     }
     
     return 0;
@@ -0,0 +1,79 @@
+#include "options.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+ShellOptions shell_options;
+
+const char *launch_mode_name(const LaunchMode mode) {
+  return mode == LaunchMode::Spawn ? "spawn" : "clone";
+}
+
+// Размер в байтах с необязательным суффиксом K/M/G
+static bool parse_size(const std::string &value, size_t &size) {
+  char *end;
+  size = strtoull(value.c_str(), &end, 10);
+  if (end == value.c_str()) {
+    return false;
+  }
+  switch (*end) {
+    case 'K': case 'k': size <<= 10; ++end; break;
+    case 'M': case 'm': size <<= 20; ++end; break;
+    case 'G': case 'g': size <<= 30; ++end; break;
+    default: break;
+  }
+  return *end == '\0';
+}
+
+// Верхняя граница ёмкости пайпа (для root её можно поднять через sysctl fs.pipe-max-size)
+static size_t pipe_max_size() {
+  std::ifstream file("/proc/sys/fs/pipe-max-size");
+  size_t size = 0;
+  file >> size;
+  return size;
+}
+
+bool set_option(const std::string &name, const std::string &value) {
+  if (name == "launch") {
+    if (value == "clone") {
+      shell_options.launch_mode = LaunchMode::Clone;
+    } else if (value == "spawn") {
+      shell_options.launch_mode = LaunchMode::Spawn;
+    } else {
+      std::cerr << "set: launch: expected clone or spawn" << std::endl;
+      return false;
+    }
+    return true;
+  }
+  if (name == "stats" || name == "perf") {
+    if (value != "on" && value != "off") {
+      std::cerr << "set: " << name << ": expected on or off" << std::endl;
+      return false;
+    }
+    (name == "stats" ? shell_options.stats : shell_options.perf) = value == "on";
+    return true;
+  }
+  if (name == "pipe-size") {
+    size_t size;
+    if (!parse_size(value, size)) {
+      std::cerr << "set: pipe-size: expected size in bytes (K/M suffix allowed)" << std::endl;
+      return false;
+    }
+    if (const size_t max_size = pipe_max_size(); max_size > 0 && size > max_size) {
+      std::cerr << "set: pipe-size: limited to pipe-max-size " << max_size << std::endl;
+      size = max_size;
+    }
+    shell_options.pipe_size = size;
+    return true;
+  }
+  std::cerr << "set: unknown option: " << name << std::endl;
+  return false;
+}
+
+void print_options() {
+  std::cout << "launch " << launch_mode_name(shell_options.launch_mode) << std::endl;
+  std::cout << "stats " << (shell_options.stats ? "on" : "off") << std::endl;
+  std::cout << "perf " << (shell_options.perf ? "on" : "off") << std::endl;
+  std::cout << "pipe-size " << shell_options.pipe_size << std::endl;
+}
@@ -0,0 +1,208 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "lexer.h"
+#include "line_reader.h"
+#include "options.h"
+#include "path_cache.h"
+#include "process.h"
+#include "stats.h"
+#include "util.h"
+
+using namespace std;
+
+namespace {
+  struct Job {
+    string line;
+    int out_fd = -1; // memfd с stdout и stderr задачи
+    ChildStats child;
+    bool done = false;
+  };
+
+  bool read_jobs(const char *path, vector<Job> &jobs) {
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+      perror(path);
+      return false;
+    }
+    LineReader reader(fd);
+    string_view line;
+    while (reader.next(line)) {
+      const size_t start = line.find_first_not_of(" \t");
+      if (start == string_view::npos || line[start] == '#') {
+        continue;
+      }
+      jobs.push_back({string(line)});
+    }
+    close(fd);
+    return !reader.failed();
+  }
+
+  void launch(Job &job, Lexer &lexer) {
+    job.child.start = StatsClock::now();
+    job.out_fd = memfd_create("parallel-job", MFD_CLOEXEC);
+    if (job.out_fd == -1) {
+      perror("memfd_create");
+      job.done = true;
+      job.child.status = 1 << 8;
+      return;
+    }
+
+    Redirections redirections;
+    auto args = parse_redirections(lexer.tokenize(job.line), redirections);
+    if (args.empty()) {
+      dprintf(job.out_fd, "Syntax error: command expected\n");
+      job.done = true;
+      job.child.status = 1 << 8;
+      return;
+    }
+
+    LaunchSpec spec;
+    spec.argv = args.data();
+    spec.path = resolve_command(args[0]);
+    if (spec.path == nullptr) {
+      dprintf(job.out_fd, "Command not found\n");
+      job.done = true;
+      job.child.status = 127 << 8;
+      return;
+    }
+    spec.stdout_fd = job.out_fd;
+    spec.stderr_fd = job.out_fd;
+    spec.redirections = std::move(redirections);
+    job.child.command = job.line;
+    job.child.pid = collect_perf ? launch_counted(spec, job.child.perf) : launch_process(spec, shell_options.launch_mode);
+    if (job.child.pid == -1) {
+      job.done = true;
+      job.child.status = 127 << 8;
+    }
+  }
+
+  void print_output(Job &job) {
+    if (job.out_fd == -1) {
+      return;
+    }
+    char buffer[64 * 1024];
+    ssize_t n;
+    off_t offset = 0;
+    while ((n = pread(job.out_fd, buffer, sizeof(buffer), offset)) > 0) {
+      offset += n;
+      for (ssize_t written = 0; written < n;) {
+        const ssize_t w = write(STDOUT_FILENO, buffer + written, n - written);
+        if (w == -1) {
+          if (errno == EINTR) {
+            continue;
+          }
+          perror("write");
+          break;
+        }
+        written += w;
+      }
+    }
+    close(job.out_fd);
+    job.out_fd = -1;
+  }
+}
+
+int run_parallel(char **argv) {
+  long slots = sysconf(_SC_NPROCESSORS_ONLN);
+  const char *path = nullptr;
+  for (int i = 1; argv[i] != nullptr; ++i) {
+    if (strcmp(argv[i], "-j") == 0 && argv[i + 1] != nullptr) {
+      slots = strtol(argv[++i], nullptr, 10);
+    } else if (path == nullptr) {
+      path = argv[i];
+    } else {
+      path = nullptr;
+      break;
+    }
+  }
+  if (path == nullptr || slots <= 0) {
+    cerr << "parallel: usage: parallel [-j N] FILE" << endl;
+    return kParallelError;
+  }
+
+  vector<Job> jobs;
+  if (!read_jobs(path, jobs)) {
+    return kParallelError;
+  }
+
+  // SIGCHLD блокируется и ожидается через sigwaitinfo: цикл спит, пока ни одна задача не завершилась.
+  // Сигналы одного типа сливаются, поэтому после пробуждения проверяются все задачи в полёте.
+  sigset_t chld, old_mask;
+  sigemptyset(&chld);
+  sigaddset(&chld, SIGCHLD);
+  sigprocmask(SIG_BLOCK, &chld, &old_mask);
+
+  cout.flush();
+  Lexer lexer;
+  vector<size_t> in_flight;
+  size_t next = 0;
+  size_t printed = 0;
+  const auto start = StatsClock::now();
+
+  while (printed < jobs.size()) {
+    while (in_flight.size() < static_cast<size_t>(slots) && next < jobs.size()) {
+      launch(jobs[next], lexer);
+      if (!jobs[next].done) {
+        in_flight.push_back(next);
+      }
+      ++next;
+    }
+
+    bool reaped = false;
+    for (auto it = in_flight.begin(); it != in_flight.end();) {
+      Job &job = jobs[*it];
+      if (wait_child(job.child, WNOHANG) > 0) {
+        job.done = true;
+        if (collect_stats) {
+          emit_stats("job", job.child, static_cast<int>(*it));
+        }
+        it = in_flight.erase(it);
+        reaped = true;
+      } else {
+        ++it;
+      }
+    }
+
+    // Вывод отдаётся строго в порядке входного файла
+    while (printed < jobs.size() && jobs[printed].done) {
+      print_output(jobs[printed++]);
+    }
+
+    if (!reaped && !in_flight.empty()) {
+      sigwaitinfo(&chld, nullptr);
+    }
+  }
+
+  sigprocmask(SIG_SETMASK, &old_mask, nullptr);
+  const double elapsed = chrono::duration<double>(StatsClock::now() - start).count();
+
+  vector<double> latencies;
+  size_t failed = 0;
+  for (const Job &job : jobs) {
+    latencies.push_back(job.child.wall_seconds);
+    if (!WIFEXITED(job.child.status) || WEXITSTATUS(job.child.status) != 0) {
+      ++failed;
+    }
+  }
+  sort(latencies.begin(), latencies.end());
+
+  fprintf(stderr,
+          "[parallel: %zu jobs, %zu failed, %ld slots, %.3f s, %.1f jobs/s; latency p50 %.3f s, p95 %.3f s, "
+          "p99 %.3f s, max %.3f s]\n",
+          jobs.size(), failed, slots, elapsed, elapsed > 0 ? jobs.size() / elapsed : 0.0, percentile(latencies, 50),
+          percentile(latencies, 95), percentile(latencies, 99), latencies.empty() ? 0.0 : latencies.back());
+  return failed == 0 ? 0 : 1;
+}
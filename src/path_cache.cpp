@@ -0,0 +1,142 @@
+#include "path_cache.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "util.h"
+
+namespace {
+  struct Entry {
+    std::string path;
+    size_t dir = 0;  // индекс каталога в dirs
+    unsigned hits = 0;
+  };
+
+  struct PathDir {
+    std::string path;
+    timespec mtime{};
+    bool relative = false;  // зависит от текущего каталога, поэтому не кешируется
+  };
+
+  std::unordered_map<std::string, Entry> table;
+  std::vector<PathDir> dirs;
+  // Путь, найденный в относительном каталоге; действителен до следующего resolve_command
+  std::string relative_match;
+  bool dirs_loaded = false;
+  time_t last_check = 0;
+
+  timespec dir_mtime(const std::string &path) {
+    struct stat st{};
+    if (stat(path.c_str(), &st) != 0) {
+      return {};
+    }
+    return st.st_mtim;
+  }
+
+  void load_dirs() {
+    dirs.clear();
+    const char *env = getenv("PATH");
+    for (auto &dir : split(env != nullptr ? env : "", ':')) {
+      // Пустой элемент PATH означает текущий каталог
+      if (dir.empty()) {
+        dir = ".";
+      }
+      const bool relative = dir[0] != '/';
+      const timespec mtime = relative ? timespec{} : dir_mtime(dir);
+      dirs.push_back({std::move(dir), mtime, relative});
+    }
+    dirs_loaded = true;
+    last_check = time(nullptr);
+  }
+
+  // Проверка mtime каталогов не чаще раза в секунду: длинный скрипт платит
+  // один проход stat() в секунду вместо поиска по PATH на каждую команду
+  void validate_dirs() {
+    const time_t now = time(nullptr);
+    if (now == last_check) {
+      return;
+    }
+    last_check = now;
+    for (const auto &dir : dirs) {
+      if (dir.relative) {
+        continue;
+      }
+      const timespec mtime = dir_mtime(dir.path);
+      if (mtime.tv_sec != dir.mtime.tv_sec || mtime.tv_nsec != dir.mtime.tv_nsec) {
+        path_cache_clear();
+        load_dirs();
+        return;
+      }
+    }
+  }
+
+  bool is_executable(const std::string &path) {
+    struct stat st{};
+    return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) && access(path.c_str(), X_OK) == 0;
+  }
+}
+
+const char *resolve_command(const char *name) {
+  // Пути с '/' не ищутся в PATH
+  if (strchr(name, '/') != nullptr) {
+    return name;
+  }
+  if (!dirs_loaded) {
+    load_dirs();
+  } else {
+    validate_dirs();
+  }
+
+  // Относительные каталоги ("." и пустые элементы PATH) после cd указывают в другое место:
+  // они проверяются при каждом поиске, если стоят в PATH раньше закешированного каталога
+  const auto it = table.find(name);
+  const size_t end = it != table.end() ? it->second.dir : dirs.size();
+  for (size_t i = 0; i < end; ++i) {
+    const PathDir &dir = dirs[i];
+    if (it != table.end() && !dir.relative) {
+      continue;
+    }
+    std::string candidate = dir.path + "/" + name;
+    if (!is_executable(candidate)) {
+      continue;
+    }
+    if (dir.relative) {
+      relative_match = std::move(candidate);
+      return relative_match.c_str();
+    }
+    auto &entry = table[name];
+    entry.path = std::move(candidate);
+    entry.dir = i;
+    entry.hits = 1;
+    return entry.path.c_str();
+  }
+
+  if (it != table.end()) {
+    ++it->second.hits;
+    return it->second.path.c_str();
+  }
+  return nullptr;
+}
+
+void path_cache_clear() {
+  table.clear();
+  dirs_loaded = false;
+}
+
+void path_cache_print() {
+  if (table.empty()) {
+    std::cout << "hash: hash table empty" << std::endl;
+    return;
+  }
+  std::cout << "hits\tcommand" << std::endl;
+  for (const auto &[name, entry] : table) {
+    std::cout << entry.hits << "\t" << entry.path << std::endl;
+  }
+}
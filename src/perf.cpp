@@ -0,0 +1,153 @@
+#include "perf.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+bool collect_perf = false;
+
+namespace {
+  struct EventSpec {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+  };
+
+  constexpr uint64_t kLlcReadMiss = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+  const EventSpec kHardwareEvents[kPerfEvents] = {
+      {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {"cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {"llc_misses", PERF_TYPE_HW_CACHE, kLlcReadMiss},
+      {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+  };
+
+  const EventSpec kSoftwareEvents[kPerfEvents] = {
+      {"task_clock_ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+      {"context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+      {"cpu_migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS},
+      {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+      {"major_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ},
+  };
+
+  // Доступность аппаратных счётчиков и ядра выясняется один раз на весь сеанс
+  int hardware_available = -1;
+  bool exclude_kernel = false;
+
+  int open_event(const EventSpec &event, const pid_t pid) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = event.type;
+    attr.config = event.config;
+    attr.disabled = 1;
+    attr.enable_on_exec = 1;
+    attr.inherit = 1;
+    attr.exclude_hv = 1;
+    attr.exclude_kernel = exclude_kernel;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    long fd = syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    // perf_event_paranoid >= 2 разрешает непривилегированным только user-space
+    if (fd == -1 && errno == EACCES && !exclude_kernel) {
+      exclude_kernel = true;
+      attr.exclude_kernel = 1;
+      fd = syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    }
+    return static_cast<int>(fd);
+  }
+
+  void open_counters(PerfCounters &counters, const pid_t pid) {
+    if (hardware_available != 0) {
+      counters.fds[0] = open_event(kHardwareEvents[0], pid);
+      // ESRCH - потомок умер до exec (ошибка перенаправления), о PMU это ничего не говорит
+      if (counters.fds[0] != -1) {
+        hardware_available = 1;
+      } else if (errno != ESRCH) {
+        hardware_available = 0;
+      }
+    }
+    if (hardware_available == -1) {
+      return;
+    }
+    counters.software = hardware_available == 0;
+    const EventSpec *events = counters.software ? kSoftwareEvents : kHardwareEvents;
+    for (size_t i = counters.software ? 0 : 1; i < kPerfEvents; ++i) {
+      counters.fds[i] = open_event(events[i], pid);
+    }
+    for (const int fd : counters.fds) {
+      counters.opened |= fd != -1;
+    }
+    if (!counters.opened) {
+      perror("perf_event_open");
+    }
+  }
+}
+
+pid_t launch_counted(LaunchSpec &spec, PerfCounters &counters) {
+  int sync[2];
+  if (pipe2(sync, O_CLOEXEC) == -1) {
+    perror("pipe2");
+    return launch_process(spec, LaunchMode::Clone);
+  }
+  spec.start_fd = sync[0];
+  spec.close_fds.push_back(sync[1]);
+  const pid_t pid = launch_process(spec, LaunchMode::Clone);
+  spec.close_fds.pop_back();
+  spec.start_fd = -1;
+  close(sync[0]);
+  if (pid != -1) {
+    open_counters(counters, pid);
+  }
+  close(sync[1]);
+  return pid;
+}
+
+void perf_read(PerfCounters &counters) {
+  for (size_t i = 0; i < kPerfEvents; ++i) {
+    if (counters.fds[i] == -1) {
+      continue;
+    }
+    uint64_t data[3]; // value, time_enabled, time_running
+    if (read(counters.fds[i], data, sizeof(data)) == sizeof(data) && data[2] > 0) {
+      // Событие делило PMU с другими: экстраполируем на всё время работы
+      const double scale = data[2] < data[1] ? static_cast<double>(data[1]) / data[2] : 1.0;
+      counters.values[i] = static_cast<int64_t>(data[0] * scale);
+    }
+    close(counters.fds[i]);
+    counters.fds[i] = -1;
+  }
+}
+
+void perf_add(PerfCounters &total, const PerfCounters &counters) {
+  if (!counters.opened) {
+    return;
+  }
+  total.opened = true;
+  total.software = counters.software;
+  for (size_t i = 0; i < kPerfEvents; ++i) {
+    if (counters.values[i] >= 0) {
+      total.values[i] = (total.values[i] > 0 ? total.values[i] : 0) + counters.values[i];
+    }
+  }
+}
+
+void perf_print(const PerfCounters &counters) {
+  if (!counters.opened) {
+    return;
+  }
+  const EventSpec *events = counters.software ? kSoftwareEvents : kHardwareEvents;
+  fprintf(stderr, ",\"perf\":{\"events\":\"%s\"", counters.software ? "software" : "hardware");
+  for (size_t i = 0; i < kPerfEvents; ++i) {
+    if (counters.values[i] >= 0) {
+      fprintf(stderr, ",\"%s\":%lld", events[i].name, static_cast<long long>(counters.values[i]));
+    }
+  }
+  if (!counters.software && counters.values[0] > 0 && counters.values[1] >= 0) {
+    fprintf(stderr, ",\"ipc\":%.3f", static_cast<double>(counters.values[1]) / counters.values[0]);
+  }
+  fprintf(stderr, "}");
+}
@@ -1,34 +1,215 @@
 #include "process.h"
 
+#include <cerrno>
+#include <csignal>
 #include <cstring>
+#include <fcntl.h>
+#include <iostream>
 #include <linux/sched.h>
+#include <set>
+#include <spawn.h>
 #include <sys/syscall.h>
 #include <sys/wait.h>
+#include <unistd.h>
 
-long create_process() {
+extern char **environ;
+
+static const std::set<std::string, std::less<>> redirOperators = {">", "<", ">>"};
+
+// Убирает перенаправления из args на месте, сохраняя argv NUL-терминированным
+std::span<char *> parse_redirections(std::span<char *> args, Redirections &redirections) {
+  size_t count = 0;
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (redirOperators.contains(std::string_view(args[i]))) {
+      if (i + 1 >= args.size()) {
+        std::cout << "Syntax error: missing filename for " << args[i] << std::endl;
+        break;
+      }
+      redirections.emplace_back(args[i], args[i + 1]);
+      ++i; // Пропускаем имя файла
+    } else {
+      args[count++] = args[i];
+    }
+  }
+  args.data()[count] = nullptr;
+  return args.first(count);
+}
+
+long create_process(int *pidfd) {
   clone_args args = {};
-  args.flags = 0;
+  args.flags = pidfd != nullptr ? CLONE_PIDFD : 0;
+  args.pidfd = reinterpret_cast<uint64_t>(pidfd);
   args.exit_signal = SIGCHLD;
   return syscall(SYS_clone3, &args, sizeof(args));
 }
 
-char **get_argv_ptr(const std::vector<std::string> &args) {
-  const auto argv = new char *[args.size() + 1];
-  for (int i = 0; i < args.size(); ++i) {
-    argv[i] = strdup(args[i].c_str());
+// Флаги open() и целевой дескриптор для оператора перенаправления
+static int redirection_flags(const std::string_view op, int &target_fd) {
+  if (op == ">") {
+    target_fd = STDOUT_FILENO;
+    return O_WRONLY | O_CREAT | O_TRUNC;
+  }
+  if (op == ">>") {
+    target_fd = STDOUT_FILENO;
+    return O_WRONLY | O_CREAT | O_APPEND;
+  }
+  target_fd = STDIN_FILENO;
+  return O_RDONLY;
+}
+
+void apply_redirections_in_child(const Redirections &redirections) {
+  for (const auto &[op, path] : redirections) {
+    int target_fd;
+    const int flags = redirection_flags(op, target_fd);
+    const int fd = open(path, flags, 0644);
+    if (fd == -1) {
+      std::cout << "open error: " << path << std::endl;
+      exit(1);
+    }
+    if (dup2(fd, target_fd) == -1) {
+      std::cout << "dup2 error" << std::endl;
+      close(fd);
+      exit(1);
+    }
+    close(fd);
+  }
+}
+
+static int child_routine(const LaunchSpec &spec) {
+  const int ret = spec.path != nullptr ? execv(spec.path, spec.argv) : execvp(spec.argv[0], spec.argv);
+  if (ret == -1) {
+    std::cerr << "Command not found" << std::endl;
+    exit(1);
+  }
+  return 0;
+}
+
+// Окружение потомка после clone3: маска сигналов, пайпы, перенаправления
+static void setup_child(const LaunchSpec &spec) {
+  sigset_t empty;
+  sigemptyset(&empty);
+  sigprocmask(SIG_SETMASK, &empty, nullptr);
+  // Пайпы подключаем первыми, файловые перенаправления имеют приоритет
+  if (spec.stdin_fd != -1) {
+    dup2(spec.stdin_fd, STDIN_FILENO);
+  }
+  if (spec.stdout_fd != -1) {
+    dup2(spec.stdout_fd, STDOUT_FILENO);
+  }
+  if (spec.stderr_fd != -1) {
+    dup2(spec.stderr_fd, STDERR_FILENO);
+  }
+  for (const int fd : spec.close_fds) {
+    close(fd);
+  }
+  if (!spec.redirections.empty()) {
+    apply_redirections_in_child(spec.redirections);
+  }
+}
+
+static pid_t launch_clone(const LaunchSpec &spec) {
+  const long pid = create_process(spec.pidfd);
+  if (pid == -1) {
+    std::cout << "create_process error" << std::endl;
+    return -1;
+  }
+  if (pid == 0) {
+    setup_child(spec);
+    if (spec.start_fd != -1) {
+      char c;
+      while (read(spec.start_fd, &c, 1) == -1 && errno == EINTR) {
+      }
+    }
+    child_routine(spec);
+    exit(1);
+  }
+  return static_cast<pid_t>(pid);
+}
+
+// posix_spawn в glibc создаёт потомка через clone(CLONE_VM | CLONE_VFORK) на отдельном стеке,
+// поэтому стоимость запуска не зависит от размера адресного пространства шелла
+static pid_t launch_spawn(const LaunchSpec &spec) {
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  if (spec.stdin_fd != -1) {
+    posix_spawn_file_actions_adddup2(&actions, spec.stdin_fd, STDIN_FILENO);
+  }
+  if (spec.stdout_fd != -1) {
+    posix_spawn_file_actions_adddup2(&actions, spec.stdout_fd, STDOUT_FILENO);
+  }
+  if (spec.stderr_fd != -1) {
+    posix_spawn_file_actions_adddup2(&actions, spec.stderr_fd, STDERR_FILENO);
+  }
+  for (const int fd : spec.close_fds) {
+    posix_spawn_file_actions_addclose(&actions, fd);
+  }
+  for (const auto &[op, path] : spec.redirections) {
+    int target_fd;
+    const int flags = redirection_flags(op, target_fd);
+    posix_spawn_file_actions_addopen(&actions, target_fd, path, flags, 0644);
+  }
+
+  // Маска сигналов шелла (например, заблокированный в parallel SIGCHLD) не должна наследоваться
+  posix_spawnattr_t attr;
+  posix_spawnattr_init(&attr);
+  sigset_t empty;
+  sigemptyset(&empty);
+  posix_spawnattr_setsigmask(&attr, &empty);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+  pid_t pid;
+  const int err = spec.path != nullptr
+                      ? posix_spawn(&pid, spec.path, &actions, &attr, spec.argv, environ)
+                      : posix_spawnp(&pid, spec.argv[0], &actions, &attr, spec.argv, environ);
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+  if (err != 0) {
+    if (err == ENOENT && spec.redirections.empty()) {
+      std::cerr << "Command not found" << std::endl;
+    } else {
+      std::cerr << spec.argv[0] << ": " << strerror(err) << std::endl;
+    }
+    return -1;
+  }
+  if (spec.pidfd != nullptr) {
+    *spec.pidfd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+  }
+  return pid;
+}
+
+// Встроенные команды конвейера выполняются в потомке без exec, поэтому всегда через clone3
+pid_t launch_builtin(const LaunchSpec &spec, int (*builtin)(char **argv)) {
+  const long pid = create_process(spec.pidfd);
+  if (pid == -1) {
+    std::cout << "create_process error" << std::endl;
+    return -1;
+  }
+  if (pid == 0) {
+    setup_child(spec);
+    _exit(builtin(spec.argv));
+  }
+  return static_cast<pid_t>(pid);
+}
+
+bool create_pipe(int fds[2], const size_t capacity) {
+  if (pipe(fds) == -1) {
+    perror("pipe");
+    return false;
+  }
+  if (capacity > 0 && fcntl(fds[1], F_SETPIPE_SZ, static_cast<int>(capacity)) == -1) {
+    perror("F_SETPIPE_SZ");
   }
-  argv[args.size()] = nullptr;
-  return argv;
+  return true;
 }
 
-void free_argv(char **argv, const size_t size) {
-  for (int i = 0; i < size; ++i) {
-    free(argv[i]);
+pid_t launch_process(const LaunchSpec &spec, const LaunchMode mode) {
+  if (mode == LaunchMode::Spawn) {
+    return launch_spawn(spec);
   }
-  delete[] argv;
+  return launch_clone(spec);
 }
 
 //1)//\n ->n +
 //2)or -> || +
 //3) add &
-//4) add pipe +
\ No newline at end of file
+//4) add pipe +
@@ -0,0 +1,300 @@
+#include "shell.h"
+
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "jobs.h"
+#include "options.h"
+#include "parallel.h"
+#include "path_cache.h"
+#include "process.h"
+#include "stats.h"
+#include "tee.h"
+
+using namespace std;
+
+static const set<string, less<>> specCommands = {"cd", "export", "unset", "set", "hash", "parallel"};
+
+bool is_spec_command(const string_view name) {
+  return specCommands.contains(name);
+}
+
+bool exec_spec_commands(char **argv, int &status) {
+  status = 0;
+  if (string(argv[0]) == "cd") {
+    const char *dir = argv[1] != nullptr ? argv[1] : getenv("HOME");
+    if (dir == nullptr) {
+      cerr << "cd: HOME not set" << endl;
+      return false;
+    }
+    if (chdir(dir) != 0) {
+      perror("chdir");
+      cerr << "dir:" << dir << endl;
+      return false;
+    }
+  } else if (string(argv[0]) == "export") {
+    const char *eq = argv[1] != nullptr ? strchr(argv[1], '=') : nullptr;
+    if (eq == nullptr || eq == argv[1]) {
+      cerr << "export: invalid argument" << endl;
+      return false;
+    }
+    // setenv копирует строку: argv освобождается сразу после выполнения команды
+    const string name(argv[1], eq - argv[1]);
+    if (setenv(name.c_str(), eq + 1, 1) != 0) {
+      cerr << "Error setting environment variable: " << argv[1] << endl;
+      return false;
+    }
+    if (name == "PATH") {
+      path_cache_clear();
+    }
+  } else if (string(argv[0]) == "unset") {
+    if (argv[1] == nullptr) {
+      cerr << "unset: missing argument" << endl;
+      return false;
+    }
+    if (unsetenv(argv[1]) != 0) {
+      cerr << "Error unsetting environment variable: " << argv[1] << endl;
+      return false;
+    }
+    if (string(argv[1]) == "PATH") {
+      path_cache_clear();
+    }
+  } else if (string(argv[0]) == "hash") {
+    if (argv[1] == nullptr) {
+      path_cache_print();
+    } else if (string(argv[1]) == "-r") {
+      path_cache_clear();
+    } else {
+      for (int i = 1; argv[i] != nullptr; ++i) {
+        if (resolve_command(argv[i]) == nullptr) {
+          cerr << "hash: " << argv[i] << ": not found" << endl;
+          return false;
+        }
+      }
+    }
+  } else if (string(argv[0]) == "set") {
+    if (argv[1] == nullptr) {
+      print_options();
+      return true;
+    }
+    if (argv[2] == nullptr) {
+      cerr << "set: usage: set <option> <value>" << endl;
+      return false;
+    }
+    return set_option(argv[1], argv[2]);
+  } else if (string(argv[0]) == "parallel") {
+    const int code = run_parallel(argv);
+    if (code == kParallelError) {
+      return false;
+    }
+    // Упавшие задачи - не ошибка builtin: parallel уже отчитался о них в сводке
+    status = code;
+  }
+  return true;
+}
+
+int execute_command(span<char *> args, bool background) {
+    if (args.empty()) {
+      return 0;
+    }
+  
+    // Парсим перенаправления
+    Redirections redirections;
+    auto command_args = parse_redirections(args, redirections);
+    
+    if (command_args.empty()) {
+        cout << "Syntax error: command expected" << endl;
+        return 1;
+    }
+  
+    char **argv = command_args.data();
+  
+    if (string(argv[0]) == "exit") {
+      exit(EXIT_SUCCESS);
+    }
+  
+    if (specCommands.contains(string_view(argv[0]))) {
+      // Специальные команды не поддерживают перенаправления
+      if (!redirections.empty()) {
+          cout << "Special commands do not support redirections" << endl;
+          return 1;
+      }
+      int status = 0;
+      if (!exec_spec_commands(argv, status)) {
+        return 1;
+      }
+      return status;
+    }
+  
+    LaunchSpec spec;
+    spec.argv = argv;
+    spec.path = resolve_command(argv[0]);
+    spec.redirections = std::move(redirections);
+    int pidfd = -1;
+    if (background) {
+      spec.pidfd = &pidfd;
+    }
+    ChildStats child;
+    child.start = StatsClock::now();
+    child.pid = collect_perf ? launch_counted(spec, child.perf) : launch_process(spec, shell_options.launch_mode);
+    if (child.pid == -1) {
+      return 1;
+    }
+  
+    if (background) {
+      const pid_t pid = child.pid;
+      child.command = command_line(argv);
+      jobs_add(pidfd, std::move(child));
+      cout << "[Background process started with PID: " << pid << "]" << endl;
+      return 0;
+    }
+  
+    // wait4 перезапускается при EINTR и заодно возвращает rusage потомка
+    if (wait_child(child) == -1) {
+        cout << "waitpid error" << endl;
+        return 1;
+    }
+    if (collect_stats) {
+        child.command = command_line(argv);
+        emit_stats("command", child);
+    }
+    const int status = child.status;
+    
+    if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        cout << "Process terminated by signal: " << WTERMSIG(status) << endl;
+        return 128 + WTERMSIG(status);
+    } else {
+        return 1;
+    }
+  }
+
+// Обновленная функция для конвейеров
+int execute_pipeline(const vector<span<char *>> &commands) {
+    if (commands.empty()) {
+        return 0;
+    }
+
+    int num_commands = commands.size();
+    vector<ChildStats> stages(num_commands);
+    vector<int> pidfds(num_commands, -1);
+    
+    // Создаем пайпы для связи между процессами (ёмкость задается set pipe-size)
+    vector<vector<int>> pipes(num_commands - 1, vector<int>(2));
+    
+    for (int i = 0; i < num_commands - 1; ++i) {
+        if (!create_pipe(pipes[i].data(), shell_options.pipe_size)) {
+            return 1;
+        }
+    }
+
+    const auto start = StatsClock::now();
+
+    // Создаем процессы для каждой команды в конвейере
+    for (int i = 0; i < num_commands; ++i) {
+        Redirections redirections;
+        auto command_args = parse_redirections(commands[i], redirections);
+        if (command_args.empty()) {
+            cerr << "Syntax error: command expected" << endl;
+            continue;
+        }
+
+        // Пайпы подключаются до файловых перенаправлений, поэтому последние имеют приоритет
+        LaunchSpec spec;
+        spec.argv = command_args.data();
+        spec.path = resolve_command(spec.argv[0]);
+        spec.stdin_fd = i > 0 ? pipes[i - 1][0] : -1;
+        spec.stdout_fd = i < num_commands - 1 ? pipes[i][1] : -1;
+        for (const auto &pipe : pipes) {
+            spec.close_fds.push_back(pipe[0]);
+            spec.close_fds.push_back(pipe[1]);
+        }
+        spec.redirections = std::move(redirections);
+        spec.pidfd = &pidfds[i];
+
+        stages[i].start = StatsClock::now();
+        if (is_builtin_tee(spec.argv)) {
+            stages[i].pid = launch_builtin(spec, builtin_tee);
+        } else if (collect_perf) {
+            stages[i].pid = launch_counted(spec, stages[i].perf);
+        } else {
+            stages[i].pid = launch_process(spec, shell_options.launch_mode);
+        }
+        if (collect_stats) {
+            stages[i].command = command_line(spec.argv);
+        }
+    }
+
+    // Закрываем все пайпы в родительском процессе
+    for (auto &pipe : pipes) {
+        close(pipe[0]);
+        close(pipe[1]);
+    }
+
+    // Ждем завершения всех процессов
+    wait_children(stages, pidfds);
+    
+    if (collect_stats) {
+        emit_pipeline_stats(stages, chrono::duration<double>(StatsClock::now() - start).count());
+    }
+    
+    const ChildStats &last = stages.back();
+    if (last.pid != -1 && WIFEXITED(last.status)) {
+        return WEXITSTATUS(last.status);
+    } else {
+        return 1;
+    }
+}
+
+bool handle_or_command(span<char *> args) {
+    size_t or_pos = 0;
+    bool found_or = false;
+    
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (strcmp(args[i], "||") == 0) {
+            or_pos = i;
+            found_or = true;
+            break;
+        }
+    }
+    
+    if (!found_or || or_pos == 0 || or_pos >= args.size() - 1) {
+        cerr << "||: invalid syntax. Usage: command1 || command2" << endl;
+        return false;
+    }
+
+    // Разрезаем argv на месте: "||" становится терминатором первой команды
+    args[or_pos] = nullptr;
+    auto first_command = args.first(or_pos);
+    auto second_command = args.subspan(or_pos + 1);
+
+    if (execute_command(first_command) != 0) {
+        execute_command(second_command);
+    }
+
+    return true;
+}
+
+vector<span<char *>> parse_pipeline(span<char *> args) {
+    vector<span<char *>> commands;
+    size_t start = 0;
+    
+    for (size_t i = 0; i <= args.size(); ++i) {
+        if (i == args.size() || strcmp(args[i], "|") == 0) {
+            if (i > start) {
+                commands.push_back(args.subspan(start, i - start));
+            }
+            if (i < args.size()) {
+                args[i] = nullptr;
+            }
+            start = i + 1;
+        }
+    }
+    
+    return commands;
+}
@@ -0,0 +1,160 @@
+#include "stats.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <poll.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+bool collect_stats = false;
+
+namespace {
+  double seconds(const timeval &tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+  }
+
+  std::string json_escape(const std::string &s) {
+    std::string out;
+    out.reserve(s.size());
+    for (const char c : s) {
+      if (c == '"' || c == '\\') {
+        out += '\\';
+        out += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char buffer[8];
+        snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+        out += buffer;
+      } else {
+        out += c;
+      }
+    }
+    return out;
+  }
+
+  // Поля rusage, общие для процесса и суммы по конвейеру
+  void print_usage(const rusage &usage) {
+    fprintf(stderr,
+            "\"user_s\":%.6f,\"sys_s\":%.6f,\"max_rss_kb\":%ld,\"minflt\":%ld,\"majflt\":%ld,\"nvcsw\":%ld,"
+            "\"nivcsw\":%ld",
+            seconds(usage.ru_utime), seconds(usage.ru_stime), usage.ru_maxrss, usage.ru_minflt, usage.ru_majflt,
+            usage.ru_nvcsw, usage.ru_nivcsw);
+  }
+
+  void finish(ChildStats &child) {
+    child.wall_seconds = std::chrono::duration<double>(StatsClock::now() - child.start).count();
+    perf_read(child.perf);
+  }
+}
+
+std::string command_line(char **argv) {
+  std::string line;
+  for (int i = 0; argv[i] != nullptr; ++i) {
+    if (i > 0) {
+      line += ' ';
+    }
+    line += argv[i];
+  }
+  return line;
+}
+
+pid_t wait_child(ChildStats &child, const int options) {
+  pid_t result;
+  do {
+    result = wait4(child.pid, &child.status, options, &child.usage);
+  } while (result == -1 && errno == EINTR);
+  if (result > 0) {
+    finish(child);
+  }
+  return result;
+}
+
+void wait_children(std::vector<ChildStats> &children, const std::vector<int> &pidfds) {
+  std::vector<pollfd> fds;
+  std::vector<size_t> index;
+  std::vector<bool> reaped(children.size(), false);
+  for (size_t i = 0; i < children.size(); ++i) {
+    if (children[i].pid != -1 && pidfds[i] != -1) {
+      fds.push_back({pidfds[i], POLLIN, 0});
+      index.push_back(i);
+    }
+  }
+
+  // Стадии завершаются в произвольном порядке: poll по pidfd даёт точное время каждой
+  size_t left = fds.size();
+  while (left > 0) {
+    if (poll(fds.data(), fds.size(), -1) == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("poll");
+      break;
+    }
+    for (size_t i = 0; i < fds.size(); ++i) {
+      if (fds[i].fd != -1 && fds[i].revents != 0) {
+        reaped[index[i]] = wait_child(children[index[i]]) > 0;
+        close(fds[i].fd);
+        fds[i].fd = -1; // poll игнорирует отрицательные дескрипторы
+        --left;
+      }
+    }
+  }
+
+  for (const pollfd &fd : fds) {
+    if (fd.fd != -1) {
+      close(fd.fd);
+    }
+  }
+  for (size_t i = 0; i < children.size(); ++i) {
+    if (children[i].pid != -1 && !reaped[i]) {
+      if (wait_child(children[i]) == -1) {
+        perror("wait4");
+      }
+    }
+  }
+}
+
+void emit_stats(const char *type, const ChildStats &child, const int index) {
+  fprintf(stderr, "{\"type\":\"%s\",", type);
+  if (index >= 0) {
+    fprintf(stderr, "\"index\":%d,", index);
+  }
+  fprintf(stderr, "\"command\":\"%s\",\"pid\":%d,", json_escape(child.command).c_str(), child.pid);
+  if (WIFSIGNALED(child.status)) {
+    fprintf(stderr, "\"signal\":%d,", WTERMSIG(child.status));
+  } else {
+    fprintf(stderr, "\"exit\":%d,", WEXITSTATUS(child.status));
+  }
+  fprintf(stderr, "\"wall_s\":%.6f,", child.wall_seconds);
+  print_usage(child.usage);
+  perf_print(child.perf);
+  fprintf(stderr, "}\n");
+}
+
+void emit_pipeline_stats(const std::vector<ChildStats> &stages, const double wall_seconds) {
+  for (size_t i = 0; i < stages.size(); ++i) {
+    if (stages[i].pid != -1) {
+      emit_stats("stage", stages[i], static_cast<int>(i));
+    }
+  }
+
+  // Сумма по стадиям; max_rss - максимум, а не сумма
+  rusage total{};
+  PerfCounters perf_total;
+  for (const auto &stage : stages) {
+    perf_add(perf_total, stage.perf);
+    const rusage &u = stage.usage;
+    timeradd(&total.ru_utime, &u.ru_utime, &total.ru_utime);
+    timeradd(&total.ru_stime, &u.ru_stime, &total.ru_stime);
+    total.ru_maxrss = std::max(total.ru_maxrss, u.ru_maxrss);
+    total.ru_minflt += u.ru_minflt;
+    total.ru_majflt += u.ru_majflt;
+    total.ru_nvcsw += u.ru_nvcsw;
+    total.ru_nivcsw += u.ru_nivcsw;
+  }
+  fprintf(stderr, "{\"type\":\"pipeline\",\"stages\":%zu,\"wall_s\":%.6f,", stages.size(), wall_seconds);
+  print_usage(total);
+  perf_print(perf_total);
+  fprintf(stderr, "}\n");
+}
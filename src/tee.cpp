@@ -0,0 +1,153 @@
+#include "tee.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+  // Максимум байт, дублируемых за один вызов tee(2): не больше ёмкости пайпа
+  constexpr size_t kChunk = 1 << 20;
+
+  struct Output {
+    int fd;
+    bool splice; // false после EINVAL от splice (O_APPEND, tty и т.п.)
+  };
+
+  bool write_all(const int fd, const char *data, size_t size) {
+    while (size > 0) {
+      const ssize_t n = write(fd, data, size);
+      if (n == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      data += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  // Перекладывает ровно size байт из пайпа in в out: splice, а если out его не поддерживает - read/write
+  bool move_bytes(const int in, Output &out, size_t size) {
+    char buffer[64 * 1024];
+    while (size > 0) {
+      if (out.splice) {
+        const ssize_t n = splice(in, nullptr, out.fd, nullptr, size, SPLICE_F_MOVE);
+        if (n > 0) {
+          size -= n;
+          continue;
+        }
+        if (n == -1 && errno == EINTR) {
+          continue;
+        }
+        if (n == -1 && errno != EINVAL) {
+          return false;
+        }
+        out.splice = false;
+      }
+      const ssize_t n = read(in, buffer, size < sizeof(buffer) ? size : sizeof(buffer));
+      if (n <= 0) {
+        if (n == -1 && errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      if (!write_all(out.fd, buffer, n)) {
+        return false;
+      }
+      size -= n;
+    }
+    return true;
+  }
+
+  // Обычный tee для случаев, когда stdin или stdout не пайп
+  int copy_tee(const std::vector<Output> &files) {
+    std::vector<char> buffer(kChunk);
+    ssize_t n;
+    while ((n = read(STDIN_FILENO, buffer.data(), buffer.size())) != 0) {
+      if (n == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        perror("tee: read");
+        return 1;
+      }
+      if (!write_all(STDOUT_FILENO, buffer.data(), n)) {
+        perror("tee: write");
+        return 1;
+      }
+      for (const Output &file : files) {
+        if (!write_all(file.fd, buffer.data(), n)) {
+          perror("tee: write");
+          return 1;
+        }
+      }
+    }
+    return 0;
+  }
+}
+
+bool is_builtin_tee(char **argv) {
+  if (strcmp(argv[0], "tee") != 0) {
+    return false;
+  }
+  // Прочие ключи (-i, -p, --help) остаются внешнему tee
+  for (int i = 1; argv[i] != nullptr; ++i) {
+    if (argv[i][0] == '-' && strcmp(argv[i], "-a") != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int builtin_tee(char **argv) {
+  int flags = O_WRONLY | O_CREAT | O_TRUNC;
+  std::vector<Output> files;
+  for (int i = 1; argv[i] != nullptr; ++i) {
+    if (strcmp(argv[i], "-a") == 0) {
+      flags = O_WRONLY | O_CREAT | O_APPEND;
+      continue;
+    }
+    const int fd = open(argv[i], flags, 0644);
+    if (fd == -1) {
+      perror(argv[i]);
+      return 1;
+    }
+    files.push_back({fd, true});
+  }
+
+  // Без копирования обрабатывается не больше одного файла: tee(2) не продвигает позицию в пайпе,
+  // поэтому второй дубликат тех же байт получить нельзя
+  if (files.size() > 1) {
+    return copy_tee(files);
+  }
+
+  while (true) {
+    // tee(2) копирует ссылки на страницы пайпа stdin в пайп stdout, ничего не потребляя
+    const ssize_t n = files.empty() ? splice(STDIN_FILENO, nullptr, STDOUT_FILENO, nullptr, kChunk, SPLICE_F_MOVE)
+                                    : tee(STDIN_FILENO, STDOUT_FILENO, kChunk, 0);
+    if (n == 0) {
+      return 0;
+    }
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EINVAL) {
+        return copy_tee(files);
+      }
+      perror("tee");
+      return 1;
+    }
+    // Затем те же байты потребляются из stdin в файл
+    if (!files.empty() && !move_bytes(STDIN_FILENO, files[0], n)) {
+      perror("tee: splice");
+      return 1;
+    }
+  }
+}
@@ -1,4 +1,5 @@
 #include "util.h"
+#include <cmath>
 #include <sstream>
 #include <unistd.h>
 #include <linux/limits.h>
@@ -21,3 +22,12 @@ std::string pwd() {
   perror("getcwd");
   exit(1);
 }
+
+// Перцентиль p (0..100) по отсортированной выборке, метод ближайшего ранга
+double percentile(const std::vector<double> &sorted, const double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  const auto rank = static_cast<size_t>(std::ceil(p / 100 * sorted.size()));
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
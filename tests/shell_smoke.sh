@@ -0,0 +1,68 @@
+#!/bin/bash
+
+# Смоук-тесты разбора ввода: скрипт подаётся на stdin, сравнивается stdout.
+# Usage: ./shell_smoke.sh <CustomShell binary>
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <CustomShell binary>"
+    exit 1
+fi
+
+SHELL_BIN=$1
+FAILED=0
+SCRIPT=$(mktemp /tmp/shell-smoke-XXXXXX)
+trap 'rm -f "$SCRIPT"' EXIT
+
+# expect <name> <script> <ожидаемый stdout>
+expect() {
+    local name=$1 script=$2 expected=$3 actual
+    actual=$(printf '%s' "$script" | "$SHELL_BIN" 2>/dev/null)
+    if [ "$actual" != "$expected" ]; then
+        echo "FAIL $name"
+        echo "  expected: $(printf '%q' "$expected")"
+        echo "  actual:   $(printf '%q' "$actual")"
+        FAILED=1
+    else
+        echo "ok   $name"
+    fi
+}
+
+# expect_file <name> <script> <ожидаемый stdout>: скрипт на stdin из обычного файла
+expect_file() {
+    local name=$1 script=$2 expected=$3 actual
+    printf '%s' "$script" > "$SCRIPT"
+    actual=$("$SHELL_BIN" < "$SCRIPT" 2>/dev/null)
+    if [ "$actual" != "$expected" ]; then
+        echo "FAIL $name"
+        echo "  expected: $(printf '%q' "$expected")"
+        echo "  actual:   $(printf '%q' "$actual")"
+        FAILED=1
+    else
+        echo "ok   $name"
+    fi
+}
+
+# expect_match <name> <script> <регулярное выражение для stdout>
+expect_match() {
+    local name=$1 script=$2 pattern=$3 actual
+    actual=$(printf '%s' "$script" | "$SHELL_BIN" 2>/dev/null)
+    if ! grep -Eq "$pattern" <<< "$actual"; then
+        echo "FAIL $name"
+        echo "  pattern: $pattern"
+        echo "  actual:  $(printf '%q' "$actual")"
+        FAILED=1
+    else
+        echo "ok   $name"
+    fi
+}
+
+# Экранированный '&' - обычный символ, команда выполняется на переднем плане
+expect "escaped ampersand" $'echo a\\&\nexit\n' "a&"
+expect "escaped space" $'echo a\\ b\nexit\n' "a b"
+# Завершающий ' &' - фоновый запуск
+expect_match "trailing ampersand" $'echo b &\nexit\n' "^\[Background process started with PID: [0-9]+\]"
+# Команда, читающая stdin, видит остаток скрипта, а шелл продолжает с места, где она остановилась
+expect_file "stdin offset after line" $'wc -c\necho after\n' $'11\nafter'
+expect_file "stdin consumed by command" $'cat\nline two\necho after\n' $'line two\necho after'
+
+exit $FAILED